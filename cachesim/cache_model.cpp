@@ -0,0 +1,411 @@
+// Set-associative cache model (see cache_model.hpp)
+//
+// Each replacement policy is a small class with hit/fill/victim hooks; the
+// cache and hierarchy are templates over the policy so the per-access path
+// has no virtual calls. The Simulator interface dispatches once per replay.
+
+#include "cache_model.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+namespace cachesim {
+
+namespace {
+
+constexpr uint64_t INVALID_LINE = ~0ULL;
+
+bool is_power_of_two(uint64_t x) {
+    return x && !(x & (x - 1));
+}
+
+unsigned log2_of(uint64_t x) {
+    unsigned bits = 0;
+    while (x > 1) {
+        x >>= 1;
+        bits++;
+    }
+    return bits;
+}
+
+// Replacement policies. victim() is only called when every way of the set
+// holds a valid line; invalid ways are always filled first.
+
+class LruPolicy {
+public:
+    LruPolicy(size_t sets, unsigned ways) : ways_(ways), stamps_(sets * ways, 0) {}
+
+    void hit(size_t set, unsigned way) { stamps_[set * ways_ + way] = ++clock_; }
+    void fill(size_t set, unsigned way) { hit(set, way); }
+
+    unsigned victim(size_t set) const {
+        const uint64_t *stamps = &stamps_[set * ways_];
+        return static_cast<unsigned>(std::min_element(stamps, stamps + ways_) - stamps);
+    }
+
+private:
+    unsigned ways_;
+    uint64_t clock_ = 0;
+    std::vector<uint64_t> stamps_;
+};
+
+// Binary tree over the ways, stored heap-style (node 1 is the root) in one
+// 64-bit word per set; each node bit points towards the less recently used
+// half
+class PlruPolicy {
+public:
+    PlruPolicy(size_t sets, unsigned ways) : levels_(log2_of(ways)), trees_(sets, 0) {}
+
+    void hit(size_t set, unsigned way) {
+        uint64_t tree = trees_[set];
+        unsigned node = 1;
+        for (int level = static_cast<int>(levels_) - 1; level >= 0; level--) {
+            unsigned bit = (way >> level) & 1;
+            // Point away from the way just used
+            tree = (tree & ~(1ULL << node)) | (static_cast<uint64_t>(!bit) << node);
+            node = 2 * node + bit;
+        }
+        trees_[set] = tree;
+    }
+
+    void fill(size_t set, unsigned way) { hit(set, way); }
+
+    unsigned victim(size_t set) const {
+        uint64_t tree = trees_[set];
+        unsigned node = 1;
+        unsigned way = 0;
+        for (unsigned level = 0; level < levels_; level++) {
+            unsigned bit = (tree >> node) & 1;
+            way = 2 * way + bit;
+            node = 2 * node + bit;
+        }
+        return way;
+    }
+
+private:
+    unsigned levels_;
+    std::vector<uint64_t> trees_;
+};
+
+// Static RRIP with 2-bit re-reference prediction values, matching gem5's
+// RRIPRP defaults: fills predict a long re-reference interval, hits
+// decrement the prediction, and the victim is the first line predicted
+// distant (aging every line until one is)
+class RripPolicy {
+public:
+    static constexpr uint8_t MAX_RRPV = 3;
+
+    RripPolicy(size_t sets, unsigned ways) : ways_(ways), rrpv_(sets * ways, MAX_RRPV) {}
+
+    void hit(size_t set, unsigned way) {
+        uint8_t &rrpv = rrpv_[set * ways_ + way];
+        if (rrpv > 0) {
+            rrpv--;
+        }
+    }
+
+    void fill(size_t set, unsigned way) { rrpv_[set * ways_ + way] = MAX_RRPV - 1; }
+
+    unsigned victim(size_t set) {
+        uint8_t *rrpv = &rrpv_[set * ways_];
+        uint8_t oldest = *std::max_element(rrpv, rrpv + ways_);
+        unsigned way = static_cast<unsigned>(std::find(rrpv, rrpv + ways_, oldest) - rrpv);
+        if (oldest < MAX_RRPV) {
+            for (unsigned w = 0; w < ways_; w++) {
+                rrpv[w] += MAX_RRPV - oldest;
+            }
+        }
+        return way;
+    }
+
+private:
+    unsigned ways_;
+    std::vector<uint8_t> rrpv_;
+};
+
+template <class Policy>
+struct Level {
+    explicit Level(const CacheConfig &config)
+        : config(config),
+          sets(config.size / (static_cast<uint64_t>(config.line_size) * config.assoc)),
+          set_mask(sets - 1),
+          lines(sets * config.assoc, INVALID_LINE),
+          dirty(sets * config.assoc, 0),
+          policy(sets, config.assoc) {}
+
+    // Way holding line in its set, or -1
+    int find(size_t set, uint64_t line) const {
+        const uint64_t *ways = &lines[set * config.assoc];
+        for (unsigned w = 0; w < config.assoc; w++) {
+            if (ways[w] == line) {
+                return static_cast<int>(w);
+            }
+        }
+        return -1;
+    }
+
+    // Way to fill in a set: an invalid one if any, else the policy's victim
+    unsigned choose_way(size_t set) {
+        const uint64_t *ways = &lines[set * config.assoc];
+        for (unsigned w = 0; w < config.assoc; w++) {
+            if (ways[w] == INVALID_LINE) {
+                return w;
+            }
+        }
+        return policy.victim(set);
+    }
+
+    CacheConfig config;
+    uint64_t sets;
+    uint64_t set_mask;
+    std::vector<uint64_t> lines;    // Line address per way, INVALID_LINE if empty
+    std::vector<uint8_t> dirty;
+    Policy policy;
+    CacheStats stats;
+};
+
+template <class Policy>
+class HierarchySimulator final : public Simulator {
+public:
+    explicit HierarchySimulator(const HierarchyConfig &config)
+        : line_shift_(log2_of(config.levels.front().line_size)) {
+        for (const CacheConfig &level : config.levels) {
+            levels_.emplace_back(level);
+        }
+    }
+
+    void access(uint64_t addr, bool is_write) override {
+        access_level(0, addr >> line_shift_, is_write);
+    }
+
+    void replay(const uint64_t *trace, size_t count) override {
+        for (size_t i = 0; i < count; i++) {
+            uint64_t record = trace[i];
+            access_level(0, (record & ~TRACE_WRITE_BIT) >> line_shift_, (record & TRACE_WRITE_BIT) != 0);
+        }
+    }
+
+    std::vector<CacheStats> stats() const override {
+        std::vector<CacheStats> result;
+        for (const Level<Policy> &level : levels_) {
+            result.push_back(level.stats);
+        }
+        return result;
+    }
+
+private:
+    // Demand access (load, store, or fill request from the level above)
+    void access_level(size_t index, uint64_t line, bool is_write) {
+        if (index == levels_.size()) {
+            return;  // Memory
+        }
+        Level<Policy> &level = levels_[index];
+        size_t set = line & level.set_mask;
+        level.stats.accesses++;
+
+        int way = level.find(set, line);
+        if (way >= 0) {
+            level.stats.hits++;
+            level.policy.hit(set, static_cast<unsigned>(way));
+            level.dirty[set * level.config.assoc + way] |= is_write;
+            return;
+        }
+
+        level.stats.misses++;
+        if (is_write) {
+            level.stats.write_misses++;
+            if (!level.config.write_allocate) {
+                access_level(index + 1, line, true);
+                return;
+            }
+        }
+
+        // Fetch the line from below, then make room for it
+        access_level(index + 1, line, false);
+        install(index, set, line, is_write);
+    }
+
+    // Dirty line evicted from the level above; not a demand access
+    void writeback(size_t index, uint64_t line) {
+        if (index == levels_.size()) {
+            return;
+        }
+        Level<Policy> &level = levels_[index];
+        size_t set = line & level.set_mask;
+        int way = level.find(set, line);
+        if (way >= 0) {
+            level.dirty[set * level.config.assoc + way] = 1;
+        } else {
+            install(index, set, line, true);
+        }
+    }
+
+    void install(size_t index, size_t set, uint64_t line, bool dirty) {
+        Level<Policy> &level = levels_[index];
+        unsigned way = level.choose_way(set);
+        size_t slot = set * level.config.assoc + way;
+        if (level.lines[slot] != INVALID_LINE && level.dirty[slot]) {
+            level.stats.writebacks++;
+            writeback(index + 1, level.lines[slot]);
+        }
+        level.lines[slot] = line;
+        level.dirty[slot] = dirty;
+        level.policy.fill(set, way);
+    }
+
+    unsigned line_shift_;
+    std::vector<Level<Policy>> levels_;
+};
+
+} // namespace
+
+void validate(const HierarchyConfig &config) {
+    if (config.levels.empty()) {
+        throw std::invalid_argument("cache hierarchy has no levels");
+    }
+    for (size_t i = 0; i < config.levels.size(); i++) {
+        const CacheConfig &level = config.levels[i];
+        std::string name = "L" + std::to_string(i + 1) + " " + format_size(level.size) + " " +
+                           std::to_string(level.assoc) + "-way";
+        if (!is_power_of_two(level.line_size) || level.line_size != config.levels.front().line_size) {
+            throw std::invalid_argument(name + ": line size must be a power of two, equal on all levels");
+        }
+        if (level.assoc == 0 || level.size % (static_cast<uint64_t>(level.line_size) * level.assoc) != 0 ||
+            !is_power_of_two(level.size / (static_cast<uint64_t>(level.line_size) * level.assoc))) {
+            throw std::invalid_argument(name + ": number of sets must be a power of two");
+        }
+        if (config.replacement == Replacement::PLRU && (!is_power_of_two(level.assoc) || level.assoc > 64)) {
+            throw std::invalid_argument(name + ": PLRU needs a power-of-two associativity up to 64");
+        }
+    }
+}
+
+std::unique_ptr<Simulator> make_simulator(const HierarchyConfig &config) {
+    validate(config);
+    switch (config.replacement) {
+    case Replacement::PLRU:
+        return std::make_unique<HierarchySimulator<PlruPolicy>>(config);
+    case Replacement::RRIP:
+        return std::make_unique<HierarchySimulator<RripPolicy>>(config);
+    case Replacement::LRU:
+    default:
+        return std::make_unique<HierarchySimulator<LruPolicy>>(config);
+    }
+}
+
+std::vector<CacheStats> simulate(const HierarchyConfig &config, const std::vector<uint64_t> &trace) {
+    std::unique_ptr<Simulator> simulator = make_simulator(config);
+    simulator->replay(trace.data(), trace.size());
+    return simulator->stats();
+}
+
+std::vector<std::vector<CacheStats>> simulate_all(const std::vector<HierarchyConfig> &configs,
+                                                  const std::vector<uint64_t> &trace,
+                                                  unsigned threads) {
+    // Report configuration errors before any work starts
+    for (const HierarchyConfig &config : configs) {
+        validate(config);
+    }
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::min<size_t>(threads, configs.size()));
+
+    // Each thread takes the next unsimulated configuration; the trace is
+    // shared read-only
+    std::vector<std::vector<CacheStats>> results(configs.size());
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < configs.size(); i = next++) {
+            results[i] = simulate(configs[i], trace);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; t++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+    return results;
+}
+
+std::vector<uint64_t> load_trace(const std::string &path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        throw std::runtime_error("cannot open trace " + path);
+    }
+    std::streamsize bytes = in.tellg();
+    if (bytes % sizeof(uint64_t) != 0) {
+        throw std::runtime_error("trace " + path + " is truncated");
+    }
+    std::vector<uint64_t> trace(static_cast<size_t>(bytes) / sizeof(uint64_t));
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char *>(trace.data()), bytes)) {
+        throw std::runtime_error("error reading trace " + path);
+    }
+    return trace;
+}
+
+uint64_t parse_size(const std::string &text) {
+    size_t pos = 0;
+    while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) {
+        pos++;
+    }
+    if (pos == 0) {
+        throw std::invalid_argument("invalid size: " + text);
+    }
+    uint64_t value = std::stoull(text.substr(0, pos));
+    std::string unit = text.substr(pos);
+    for (char &c : unit) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    if (unit.empty() || unit == "b") {
+        return value;
+    }
+    if (unit == "k" || unit == "kb") {
+        return value * 1024;
+    }
+    if (unit == "m" || unit == "mb") {
+        return value * 1024 * 1024;
+    }
+    throw std::invalid_argument("invalid size: " + text);
+}
+
+std::string format_size(uint64_t bytes) {
+    // Same spelling as the gem5 sweep directories, e.g. 1024kB
+    if (bytes >= 1024 && bytes % 1024 == 0) {
+        return std::to_string(bytes / 1024) + "kB";
+    }
+    return std::to_string(bytes) + "B";
+}
+
+const char *replacement_name(Replacement replacement) {
+    switch (replacement) {
+    case Replacement::PLRU:
+        return "plru";
+    case Replacement::RRIP:
+        return "rrip";
+    case Replacement::LRU:
+    default:
+        return "lru";
+    }
+}
+
+Replacement parse_replacement(const std::string &name) {
+    for (Replacement r : {Replacement::LRU, Replacement::PLRU, Replacement::RRIP}) {
+        if (name == replacement_name(r)) {
+            return r;
+        }
+    }
+    throw std::invalid_argument("unknown replacement policy: " + name + " (lru, plru, rrip)");
+}
+
+} // namespace cachesim
@@ -0,0 +1,101 @@
+#ifndef CACHESIM_CACHE_MODEL_HPP
+#define CACHESIM_CACHE_MODEL_HPP
+
+// Set-associative cache model for fast what-if studies
+//
+// Models a hierarchy of write-back caches (L1D, L2, ...) with LRU, tree
+// PLRU or SRRIP replacement and optional write-allocate, driven by a memory
+// trace. It has no timing model: it answers "how many misses would this
+// cache configuration have" for a trace in seconds, where gem5 needs a full
+// simulation per configuration. simulate_all() replays one trace against
+// many configurations in parallel.
+//
+// Traces are arrays of 64-bit records holding the byte address of each
+// load or store, with TRACE_WRITE_BIT set for stores. Kernels built with
+// "make -C kernels reuse" write them when REUSE_TRACE_FILE is set.
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cachesim {
+
+constexpr uint64_t TRACE_WRITE_BIT = 1ULL << 63;
+
+enum class Replacement {
+    LRU,    // Least recently used (gem5's LRURP)
+    PLRU,   // Tree pseudo-LRU (gem5's TreePLRURP), power-of-two associativity
+    RRIP    // Static RRIP with 2-bit re-reference predictions (gem5's RRIPRP)
+};
+
+struct CacheConfig {
+    uint64_t size = 32 * 1024;      // Bytes
+    unsigned assoc = 2;
+    unsigned line_size = 64;        // Bytes
+    bool write_allocate = true;     // Allocate a line on a store miss
+};
+
+struct HierarchyConfig {
+    std::vector<CacheConfig> levels;    // levels[0] is closest to the CPU
+    Replacement replacement = Replacement::LRU;
+};
+
+// Counts for one cache level. Accesses are demand accesses only (misses of
+// the level above); writebacks are dirty lines this level evicted.
+struct CacheStats {
+    uint64_t accesses = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t write_misses = 0;
+    uint64_t writebacks = 0;
+
+    double miss_rate() const {
+        return accesses ? static_cast<double>(misses) / accesses : 0.0;
+    }
+};
+
+// Step-by-step interface to one hierarchy
+class Simulator {
+public:
+    virtual ~Simulator() = default;
+
+    virtual void access(uint64_t addr, bool is_write) = 0;
+
+    // Replay trace records; faster than calling access() per record
+    virtual void replay(const uint64_t *trace, size_t count) = 0;
+
+    virtual std::vector<CacheStats> stats() const = 0;
+};
+
+// Throws std::invalid_argument if a level cannot be built (the number of
+// sets and the line size must be powers of two, PLRU needs a power-of-two
+// associativity, and every level must use the same line size).
+void validate(const HierarchyConfig &config);
+
+std::unique_ptr<Simulator> make_simulator(const HierarchyConfig &config);
+
+// Replay a whole trace through one hierarchy; returns stats per level
+std::vector<CacheStats> simulate(const HierarchyConfig &config, const std::vector<uint64_t> &trace);
+
+// Replay a trace against every configuration, distributing configurations
+// over threads (0 = one per hardware thread). Results follow configs.
+std::vector<std::vector<CacheStats>> simulate_all(const std::vector<HierarchyConfig> &configs,
+                                                  const std::vector<uint64_t> &trace,
+                                                  unsigned threads = 0);
+
+// Read a binary trace file. Throws std::runtime_error on I/O errors.
+std::vector<uint64_t> load_trace(const std::string &path);
+
+// "32kB" / "1MB" / "4096" <-> bytes. parse_size throws std::invalid_argument.
+uint64_t parse_size(const std::string &text);
+std::string format_size(uint64_t bytes);
+
+const char *replacement_name(Replacement replacement);
+// Throws std::invalid_argument for unknown names
+Replacement parse_replacement(const std::string &name);
+
+} // namespace cachesim
+
+#endif
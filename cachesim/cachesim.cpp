@@ -0,0 +1,319 @@
+// Cache what-if sweeps over a memory trace
+//
+// Replays one trace against the cross product of the given L1D/L2
+// configurations and replacement policies, prints a miss-rate table and
+// optionally writes gem5-style stats.txt files laid out like the
+// run_cache_sweep.sh results, so analyze_results.py and plot_results.py
+// can compare them with gem5 runs.
+
+#include "cache_model.hpp"
+
+#include <getopt.h>
+#include <sys/stat.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace cachesim;
+
+namespace {
+
+struct Options {
+    std::string trace_path;
+    std::vector<uint64_t> l1d_sizes;
+    std::vector<unsigned> l1d_assocs = {2};
+    std::vector<uint64_t> l2_sizes = {256 * 1024};   // Empty: no L2
+    std::vector<unsigned> l2_assocs = {8};
+    std::vector<Replacement> policies = {Replacement::LRU};
+    unsigned line_size = 64;
+    bool write_allocate = true;
+    unsigned threads = 0;
+    std::string out_dir;
+};
+
+struct Run {
+    HierarchyConfig config;
+    std::string dir_name;
+};
+
+void usage(const char *prog) {
+    std::fprintf(stderr,
+        "Usage: %s <trace> [options]\n"
+        "\n"
+        "Options:\n"
+        "  --l1d-size <sizes>     L1D sizes, comma-separated (default: 8kB,16kB,32kB,64kB,128kB)\n"
+        "  --l1d-assoc <n,...>    L1D associativities (default: 2)\n"
+        "  --l2-size <sizes>      L2 sizes, or \"none\" for an L1D only (default: 256kB)\n"
+        "  --l2-assoc <n,...>     L2 associativities (default: 8)\n"
+        "  --policy <names>       Replacement policies: lru, plru, rrip (default: lru)\n"
+        "  --line-size <bytes>    Cache line size (default: 64)\n"
+        "  --no-write-allocate    Do not allocate lines on store misses\n"
+        "  --threads <n>          Worker threads (default: one per CPU)\n"
+        "  --out-dir <dir>        Write <dir>/<config>/stats.txt for each configuration\n"
+        "\n"
+        "Traces are written by kernels built with \"make -C kernels reuse\":\n"
+        "  REUSE_TRACE_FILE=mm.trace kernels/build/reuse/matrix_mult_unopt --size 128\n",
+        prog);
+}
+
+std::vector<std::string> split(const std::string &list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+std::vector<uint64_t> parse_sizes(const std::string &list) {
+    std::vector<uint64_t> sizes;
+    for (const std::string &item : split(list)) {
+        sizes.push_back(parse_size(item));
+    }
+    return sizes;
+}
+
+std::vector<unsigned> parse_counts(const std::string &list) {
+    std::vector<unsigned> counts;
+    for (const std::string &item : split(list)) {
+        counts.push_back(static_cast<unsigned>(std::stoul(item)));
+    }
+    return counts;
+}
+
+Options parse_options(int argc, char **argv) {
+    enum { L1D_SIZE = 1, L1D_ASSOC, L2_SIZE, L2_ASSOC, POLICY, LINE_SIZE, NO_WRITE_ALLOCATE, THREADS, OUT_DIR };
+    static const struct option long_options[] = {
+        {"l1d-size", required_argument, nullptr, L1D_SIZE},
+        {"l1d-assoc", required_argument, nullptr, L1D_ASSOC},
+        {"l2-size", required_argument, nullptr, L2_SIZE},
+        {"l2-assoc", required_argument, nullptr, L2_ASSOC},
+        {"policy", required_argument, nullptr, POLICY},
+        {"line-size", required_argument, nullptr, LINE_SIZE},
+        {"no-write-allocate", no_argument, nullptr, NO_WRITE_ALLOCATE},
+        {"threads", required_argument, nullptr, THREADS},
+        {"out-dir", required_argument, nullptr, OUT_DIR},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    Options options;
+    options.l1d_sizes = parse_sizes("8kB,16kB,32kB,64kB,128kB");
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", long_options, nullptr)) != -1) {
+        switch (opt) {
+        case L1D_SIZE:
+            options.l1d_sizes = parse_sizes(optarg);
+            break;
+        case L1D_ASSOC:
+            options.l1d_assocs = parse_counts(optarg);
+            break;
+        case L2_SIZE:
+            options.l2_sizes = std::string(optarg) == "none" ? std::vector<uint64_t>() : parse_sizes(optarg);
+            break;
+        case L2_ASSOC:
+            options.l2_assocs = parse_counts(optarg);
+            break;
+        case POLICY:
+            options.policies.clear();
+            for (const std::string &name : split(optarg)) {
+                options.policies.push_back(parse_replacement(name));
+            }
+            break;
+        case LINE_SIZE:
+            options.line_size = static_cast<unsigned>(std::stoul(optarg));
+            break;
+        case NO_WRITE_ALLOCATE:
+            options.write_allocate = false;
+            break;
+        case THREADS:
+            options.threads = static_cast<unsigned>(std::stoul(optarg));
+            break;
+        case OUT_DIR:
+            options.out_dir = optarg;
+            break;
+        case 'h':
+            usage(argv[0]);
+            std::exit(0);
+        default:
+            usage(argv[0]);
+            std::exit(1);
+        }
+    }
+
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        std::exit(1);
+    }
+    options.trace_path = argv[optind];
+    return options;
+}
+
+// Cross product of the options; directory names follow run_cache_sweep.sh,
+// with L2 and policy suffixes only when those are swept
+std::vector<Run> build_runs(const Options &options) {
+    bool l2_swept = options.l2_sizes.size() > 1 || options.l2_assocs.size() > 1;
+    bool policy_swept = options.policies.size() > 1;
+
+    std::vector<uint64_t> l2_sizes = options.l2_sizes;
+    std::vector<unsigned> l2_assocs = options.l2_assocs;
+    if (l2_sizes.empty()) {
+        l2_sizes = {0};
+        l2_assocs = {0};
+    }
+
+    std::vector<Run> runs;
+    for (Replacement policy : options.policies) {
+        for (uint64_t l2_size : l2_sizes) {
+            for (unsigned l2_assoc : l2_assocs) {
+                for (uint64_t l1d_size : options.l1d_sizes) {
+                    for (unsigned l1d_assoc : options.l1d_assocs) {
+                        Run run;
+                        run.config.replacement = policy;
+                        run.config.levels.push_back({l1d_size, l1d_assoc, options.line_size, options.write_allocate});
+                        if (l2_size) {
+                            run.config.levels.push_back({l2_size, l2_assoc, options.line_size, options.write_allocate});
+                        }
+
+                        run.dir_name = format_size(l1d_size) + "_assoc" + std::to_string(l1d_assoc);
+                        if (l2_swept) {
+                            run.dir_name += "_L2-" + format_size(l2_size) + "-" + std::to_string(l2_assoc) + "way";
+                        }
+                        if (policy_swept) {
+                            run.dir_name += std::string("_") + replacement_name(policy);
+                        }
+                        runs.push_back(run);
+                    }
+                }
+            }
+        }
+    }
+    return runs;
+}
+
+void make_dirs(const std::string &path) {
+    for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1)) {
+        mkdir(path.substr(0, pos).c_str(), 0755);
+        if (pos == std::string::npos) {
+            break;
+        }
+    }
+}
+
+// Ratios; counts use the exact overload below
+void write_stat(std::ofstream &out, const std::string &name, double value, const char *desc) {
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-50s %14.6g   # %s\n", name.c_str(), value, desc);
+    out << line;
+}
+
+void write_stat(std::ofstream &out, const std::string &name, uint64_t value, const char *desc) {
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-50s %14llu   # %s\n", name.c_str(),
+                  static_cast<unsigned long long>(value), desc);
+    out << line;
+}
+
+// Statistics under the names gem5 uses, so the analysis scripts read them
+void write_stats(const std::string &dir, const Run &run, const std::vector<CacheStats> &stats,
+                 const Options &options) {
+    make_dirs(dir);
+    std::ofstream out(dir + "/stats.txt");
+    out << "\n---------- Begin Simulation Statistics ----------\n";
+
+    const char *prefixes[] = {"system.cpu.dcache", "system.l2cache"};
+    for (size_t i = 0; i < stats.size() && i < 2; i++) {
+        std::string prefix = prefixes[i];
+        write_stat(out, prefix + ".overall_accesses::total", stats[i].accesses, "number of overall (read+write) accesses");
+        write_stat(out, prefix + ".overall_hits::total", stats[i].hits, "number of overall hits");
+        write_stat(out, prefix + ".overall_misses::total", stats[i].misses, "number of overall misses");
+        write_stat(out, prefix + ".overall_miss_rate::total", stats[i].miss_rate(), "miss rate for overall accesses");
+        write_stat(out, prefix + ".WriteReq_misses::total", stats[i].write_misses, "number of WriteReq misses");
+        write_stat(out, prefix + ".writebacks::total", stats[i].writebacks, "number of writebacks");
+    }
+    out << "\n---------- End Simulation Statistics   ----------\n";
+
+    const CacheConfig &l1d = run.config.levels[0];
+    std::ofstream manifest(dir + "/manifest.json");
+    manifest << "{\n"
+             << "  \"simulator\": \"cachesim\",\n"
+             << "  \"trace\": \"" << options.trace_path << "\",\n"
+             << "  \"l1d_size\": \"" << format_size(l1d.size) << "\",\n"
+             << "  \"l1d_assoc\": " << l1d.assoc << ",\n";
+    if (run.config.levels.size() > 1) {
+        manifest << "  \"l2_size\": \"" << format_size(run.config.levels[1].size) << "\",\n"
+                 << "  \"l2_assoc\": " << run.config.levels[1].assoc << ",\n";
+    }
+    manifest << "  \"replacement\": \"" << replacement_name(run.config.replacement) << "\",\n"
+             << "  \"line_size\": " << l1d.line_size << ",\n"
+             << "  \"write_allocate\": " << (l1d.write_allocate ? "true" : "false") << ",\n"
+             << "  \"status\": \"completed\"\n"
+             << "}\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    try {
+        Options options = parse_options(argc, argv);
+        std::vector<Run> runs = build_runs(options);
+
+        auto load_start = std::chrono::steady_clock::now();
+        std::vector<uint64_t> trace = load_trace(options.trace_path);
+        auto sim_start = std::chrono::steady_clock::now();
+
+        std::vector<HierarchyConfig> configs;
+        for (const Run &run : runs) {
+            configs.push_back(run.config);
+        }
+        std::vector<std::vector<CacheStats>> results = simulate_all(configs, trace, options.threads);
+
+        auto sim_end = std::chrono::steady_clock::now();
+        double load_seconds = std::chrono::duration<double>(sim_start - load_start).count();
+        double sim_seconds = std::chrono::duration<double>(sim_end - sim_start).count();
+
+        std::printf("Trace: %s (%zu accesses, loaded in %.2f s)\n\n",
+                    options.trace_path.c_str(), trace.size(), load_seconds);
+        std::printf("%-32s %12s %10s %12s %10s %12s\n",
+                    "Configuration", "L1D misses", "L1D rate", "L2 misses", "L2 rate", "Writebacks");
+        std::printf("%s\n", std::string(93, '-').c_str());
+        for (size_t i = 0; i < runs.size(); i++) {
+            const std::vector<CacheStats> &stats = results[i];
+            const CacheStats &last = stats.back();
+            if (stats.size() > 1) {
+                std::printf("%-32s %12llu %9.4f%% %12llu %9.4f%% %12llu\n", runs[i].dir_name.c_str(),
+                            (unsigned long long)stats[0].misses, stats[0].miss_rate() * 100,
+                            (unsigned long long)stats[1].misses, stats[1].miss_rate() * 100,
+                            (unsigned long long)last.writebacks);
+            } else {
+                std::printf("%-32s %12llu %9.4f%% %12s %10s %12llu\n", runs[i].dir_name.c_str(),
+                            (unsigned long long)stats[0].misses, stats[0].miss_rate() * 100,
+                            "-", "-", (unsigned long long)last.writebacks);
+            }
+
+            if (!options.out_dir.empty()) {
+                write_stats(options.out_dir + "/" + runs[i].dir_name, runs[i], stats, options);
+            }
+        }
+
+        std::printf("\n%zu configurations in %.2f s (%.0f M accesses/s)\n", runs.size(), sim_seconds,
+                    sim_seconds > 0 ? trace.size() * runs.size() / sim_seconds / 1e6 : 0.0);
+        if (!options.out_dir.empty()) {
+            std::printf("Stats written to %s/<config>/stats.txt\n", options.out_dir.c_str());
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "cachesim: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,361 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "harness.h"
+
+#define BATCH 512
+
+// Matrices per group in the interleaved layout: one AVX-512 vector, or two
+// AVX2 / four SSE2 vectors, of doubles
+#define LANES 8
+
+// Batched small-matrix multiplication
+//
+// Multiplies --size independent pairs of n x n matrices for each n in
+// 4, 8, 16 and 32, in three layouts:
+//   rows         one double** matrix per call, size known at run time, as
+//                the matrix_mult_* kernels: per-call overhead and a pointer
+//                load per row
+//   contiguous   each matrix stored row-major in one block, the batch back
+//                to back; one call per batch, size known at compile time
+//   interleaved  groups of LANES matrices stored element-interleaved:
+//                element (i, j) of the LANES matrices of a group is
+//                contiguous, so the innermost loop runs across matrices and
+//                vectorizes at every n, even n = 4
+// The contiguous and interleaved kernels are instantiated once per size, so
+// every loop bound is a constant the compiler unrolls and vectorizes for.
+//
+// All layouts compute the same products in the same order as
+// matrix_mult_unopt. Layout conversion happens outside the timed region;
+// each layout and size is also timed on its own, and the best time per
+// combination over all iterations is reported as throughput.
+
+static const int sizes[] = {4, 8, 16, 32};
+#define NUM_SIZES (int)(sizeof(sizes) / sizeof(sizes[0]))
+
+enum { LAYOUT_ROWS, LAYOUT_CONTIGUOUS, LAYOUT_INTERLEAVED, NUM_LAYOUTS };
+static const char *layout_names[NUM_LAYOUTS] = {"rows", "contiguous", "interleaved"};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Baseline: one call per matrix through the double** API
+static void gemm_rows(double **A, double **B, double **C, int n) {
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            C[i][j] = 0.0;
+        }
+        for (int k = 0; k < n; k++) {
+            double a_ik = A[i][k];
+            for (int j = 0; j < n; j++) {
+                C[i][j] += a_ik * B[k][j];
+            }
+        }
+    }
+}
+
+// Bodies shared by the per-size instances below; always_inline makes GCC
+// compile a copy of each for every constant n
+static inline __attribute__((always_inline))
+void gemm_contiguous(const double *restrict a, const double *restrict b,
+                     double *restrict c, int batch, const int n) {
+    for (int m = 0; m < batch; m++) {
+        const double *am = a + (size_t)m * n * n;
+        const double *bm = b + (size_t)m * n * n;
+        double *cm = c + (size_t)m * n * n;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                cm[i * n + j] = 0.0;
+            }
+            for (int k = 0; k < n; k++) {
+                double a_ik = am[i * n + k];
+                for (int j = 0; j < n; j++) {
+                    cm[i * n + j] += a_ik * bm[k * n + j];
+                }
+            }
+        }
+    }
+}
+
+// Element (i, j) of lane l of a group is at [(i * n + j) * LANES + l]
+static inline __attribute__((always_inline))
+void gemm_interleaved(const double *restrict a, const double *restrict b,
+                      double *restrict c, int groups, const int n) {
+    for (int g = 0; g < groups; g++) {
+        const double *ag = a + (size_t)g * n * n * LANES;
+        const double *bg = b + (size_t)g * n * n * LANES;
+        double *cg = c + (size_t)g * n * n * LANES;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                for (int l = 0; l < LANES; l++) {
+                    cg[(i * n + j) * LANES + l] = 0.0;
+                }
+            }
+            for (int k = 0; k < n; k++) {
+                for (int j = 0; j < n; j++) {
+                    for (int l = 0; l < LANES; l++) {
+                        cg[(i * n + j) * LANES + l] += ag[(i * n + k) * LANES + l] *
+                                                       bg[(k * n + j) * LANES + l];
+                    }
+                }
+            }
+        }
+    }
+}
+
+#define SPECIALIZE(n) \
+    static void gemm_contiguous_##n(const double *a, const double *b, double *c, int batch) { \
+        gemm_contiguous(a, b, c, batch, n); \
+    } \
+    static void gemm_interleaved_##n(const double *a, const double *b, double *c, int groups) { \
+        gemm_interleaved(a, b, c, groups, n); \
+    }
+
+SPECIALIZE(4)
+SPECIALIZE(8)
+SPECIALIZE(16)
+SPECIALIZE(32)
+
+typedef void (*gemm_fn)(const double *, const double *, double *, int);
+
+// Indexed like sizes[]
+static const gemm_fn contiguous_fns[] = {gemm_contiguous_4, gemm_contiguous_8,
+                                         gemm_contiguous_16, gemm_contiguous_32};
+static const gemm_fn interleaved_fns[] = {gemm_interleaved_4, gemm_interleaved_8,
+                                          gemm_interleaved_16, gemm_interleaved_32};
+
+// Operands of one matrix size in all layouts
+typedef struct {
+    int n;
+    double ***rows_a, ***rows_b, ***rows_c;      // batch double** matrices
+    double *a, *b, *c;                           // Contiguous
+    double *ia, *ib, *ic;                        // Interleaved, groups * LANES matrices
+} batch_t;
+
+double** allocate_matrix(int n) {
+    double **matrix = (double**)malloc(n * sizeof(double*));
+    for (int i = 0; i < n; i++) {
+        matrix[i] = (double*)malloc(n * sizeof(double));
+    }
+    return matrix;
+}
+
+void free_matrix(double **matrix, int n) {
+    for (int i = 0; i < n; i++) {
+        free(matrix[i]);
+    }
+    free(matrix);
+}
+
+// Same value distribution as matrix_mult_unopt
+void initialize_batch(double *data, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        data[i] = (double)(rand() % 100) / 10.0;
+    }
+}
+
+// Contiguous batch <-> interleaved groups; lanes past the batch stay zero
+static void interleave(const double *src, double *dst, int batch, int n) {
+    for (int m = 0; m < batch; m++) {
+        const double *sm = src + (size_t)m * n * n;
+        double *dg = dst + (size_t)(m / LANES) * n * n * LANES;
+        for (int e = 0; e < n * n; e++) {
+            dg[e * LANES + m % LANES] = sm[e];
+        }
+    }
+}
+
+static void deinterleave(const double *src, double *dst, int batch, int n) {
+    for (int m = 0; m < batch; m++) {
+        const double *sg = src + (size_t)(m / LANES) * n * n * LANES;
+        double *dm = dst + (size_t)m * n * n;
+        for (int e = 0; e < n * n; e++) {
+            dm[e] = sg[e * LANES + m % LANES];
+        }
+    }
+}
+
+typedef struct {
+    batch_t batches[NUM_SIZES];
+    int batch;
+    int groups;
+    double best[NUM_SIZES][NUM_LAYOUTS];         // Best time per size and layout
+    int warmup;                                  // Calls before the timed ones (h.warmup)
+    int calls;
+} gemm_ctx_t;
+
+static void run_batched(void *p) {
+    gemm_ctx_t *ctx = (gemm_ctx_t*)p;
+    for (int s = 0; s < NUM_SIZES; s++) {
+        batch_t *bt = &ctx->batches[s];
+        double times[NUM_LAYOUTS];
+        double start = now_seconds();
+        for (int m = 0; m < ctx->batch; m++) {
+            gemm_rows(bt->rows_a[m], bt->rows_b[m], bt->rows_c[m], bt->n);
+        }
+        times[LAYOUT_ROWS] = now_seconds() - start;
+
+        start = now_seconds();
+        contiguous_fns[s](bt->a, bt->b, bt->c, ctx->batch);
+        times[LAYOUT_CONTIGUOUS] = now_seconds() - start;
+
+        start = now_seconds();
+        interleaved_fns[s](bt->ia, bt->ib, bt->ic, ctx->groups);
+        times[LAYOUT_INTERLEAVED] = now_seconds() - start;
+
+        // Warmup calls are not measurements, as in the harness
+        for (int l = 0; l < NUM_LAYOUTS && ctx->calls >= ctx->warmup; l++) {
+            if (times[l] < ctx->best[s][l]) {
+                ctx->best[s][l] = times[l];
+            }
+        }
+    }
+    ctx->calls++;
+}
+
+// Largest relative difference between two layouts' results
+static double max_relative_difference(const double *x, const double *y, size_t count) {
+    double worst = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        double scale = x[i] != 0.0 ? x[i] : 1.0;
+        double diff = (x[i] - y[i]) / scale;
+        if (diff < 0) {
+            diff = -diff;
+        }
+        if (diff > worst) {
+            worst = diff;
+        }
+    }
+    return worst;
+}
+
+// Sum of all contiguous-layout results for the default seed
+static const harness_ref_t references[] = {
+    {13, 11876626.95000002},
+    {64, 58869477.090000249},
+    {512, 468117649.19000167},
+    {1000, 915027132.52003479},
+    {0, 0.0}
+};
+
+int main(int argc, char **argv) {
+    harness_t h;
+    harness_init(&h, "batched_gemm", argc, argv, BATCH);
+
+    srand(h.seed);  // Fixed seed for reproducible results
+
+    gemm_ctx_t ctx;
+    ctx.batch = h.size;
+    ctx.groups = (h.size + LANES - 1) / LANES;
+    ctx.warmup = h.warmup;
+    ctx.calls = 0;
+    for (int s = 0; s < NUM_SIZES; s++) {
+        batch_t *bt = &ctx.batches[s];
+        int n = sizes[s];
+        size_t elements = (size_t)ctx.batch * n * n;
+        size_t padded = (size_t)ctx.groups * LANES * n * n;
+        bt->n = n;
+        bt->a = (double*)malloc(elements * sizeof(double));
+        bt->b = (double*)malloc(elements * sizeof(double));
+        bt->c = (double*)malloc(elements * sizeof(double));
+        bt->ia = (double*)calloc(padded, sizeof(double));
+        bt->ib = (double*)calloc(padded, sizeof(double));
+        bt->ic = (double*)calloc(padded, sizeof(double));
+        bt->rows_a = (double***)malloc(ctx.batch * sizeof(double**));
+        bt->rows_b = (double***)malloc(ctx.batch * sizeof(double**));
+        bt->rows_c = (double***)malloc(ctx.batch * sizeof(double**));
+        if (!bt->a || !bt->b || !bt->c || !bt->ia || !bt->ib || !bt->ic ||
+            !bt->rows_a || !bt->rows_b || !bt->rows_c) {
+            fprintf(stderr, "batched_gemm: memory allocation failed\n");
+            return 1;
+        }
+
+        initialize_batch(bt->a, elements);
+        initialize_batch(bt->b, elements);
+        interleave(bt->a, bt->ia, ctx.batch, n);
+        interleave(bt->b, bt->ib, ctx.batch, n);
+        for (int m = 0; m < ctx.batch; m++) {
+            bt->rows_a[m] = allocate_matrix(n);
+            bt->rows_b[m] = allocate_matrix(n);
+            bt->rows_c[m] = allocate_matrix(n);
+            for (int i = 0; i < n; i++) {
+                memcpy(bt->rows_a[m][i], bt->a + ((size_t)m * n + i) * n, n * sizeof(double));
+                memcpy(bt->rows_b[m][i], bt->b + ((size_t)m * n + i) * n, n * sizeof(double));
+            }
+        }
+        for (int l = 0; l < NUM_LAYOUTS; l++) {
+            ctx.best[s][l] = 1e30;
+        }
+    }
+
+    harness_run(&h, run_batched, NULL, &ctx);
+
+    // The other layouts must reproduce the contiguous results
+    double checksum = 0.0;
+    int layouts_ok = 1;
+    for (int s = 0; s < NUM_SIZES; s++) {
+        batch_t *bt = &ctx.batches[s];
+        int n = bt->n;
+        size_t elements = (size_t)ctx.batch * n * n;
+        double *check = (double*)malloc(elements * sizeof(double));
+        for (size_t i = 0; i < elements; i++) {
+            checksum += bt->c[i];
+        }
+        for (int m = 0; m < ctx.batch; m++) {
+            for (int i = 0; i < n; i++) {
+                memcpy(check + ((size_t)m * n + i) * n, bt->rows_c[m][i], n * sizeof(double));
+            }
+        }
+        double rows_diff = max_relative_difference(bt->c, check, elements);
+        deinterleave(bt->ic, check, ctx.batch, n);
+        double interleaved_diff = max_relative_difference(bt->c, check, elements);
+        if (rows_diff > 1e-12 || interleaved_diff > 1e-12) {
+            fprintf(stderr, "batched_gemm: layouts disagree at n = %d (rows %g, interleaved %g)\n",
+                    n, rows_diff, interleaved_diff);
+            layouts_ok = 0;
+        }
+        free(check);
+    }
+    harness_check(&h, checksum, references, 1e-9);
+    for (int s = 0; s < NUM_SIZES; s++) {
+        size_t elements = (size_t)ctx.batch * sizes[s] * sizes[s];
+        harness_dump(&h, HARNESS_F64, (void *const *)&ctx.batches[s].c, 1, 0, (int)elements);
+    }
+
+    printf("%-6s %-12s %12s %14s %10s\n", "Size", "Layout", "Best (s)", "Matrices/s", "GFLOP/s");
+    for (int s = 0; s < NUM_SIZES; s++) {
+        int n = sizes[s];
+        for (int l = 0; l < NUM_LAYOUTS; l++) {
+            double t = ctx.best[s][l];
+            printf("%-6d %-12s %12.6f %14.0f %10.2f\n", n, layout_names[l], t,
+                   ctx.batch / t, 2.0 * n * n * n * ctx.batch / t / 1e9);
+        }
+    }
+    printf("Batched GEMM completed in %f seconds\n", harness_best_time(&h));
+
+    for (int s = 0; s < NUM_SIZES; s++) {
+        batch_t *bt = &ctx.batches[s];
+        for (int m = 0; m < ctx.batch; m++) {
+            free_matrix(bt->rows_a[m], bt->n);
+            free_matrix(bt->rows_b[m], bt->n);
+            free_matrix(bt->rows_c[m], bt->n);
+        }
+        free(bt->rows_a);
+        free(bt->rows_b);
+        free(bt->rows_c);
+        free(bt->a);
+        free(bt->b);
+        free(bt->c);
+        free(bt->ia);
+        free(bt->ib);
+        free(bt->ic);
+    }
+
+    int status = harness_finish(&h);
+    return status ? status : !layouts_ok;
+}
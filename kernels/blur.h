@@ -0,0 +1,250 @@
+#ifndef BLUR_H
+#define BLUR_H
+
+// Box-decomposed 5x5 blur, its border modes, a bounds-checked reference and
+// image allocation, shared by image_blur_box and the image_blur_video frame
+// pipeline
+//
+// The functions are static so every program compiles (and, for "make
+// reuse", instruments) its own copy together with its kernel code, and
+// inline so a program that skips one (image_blur_video has no use for
+// blur_reference) does not get an unused-function warning.
+
+#include <stdlib.h>
+#include <string.h>
+
+#define BLUR_KERNEL_SIZE 5
+#define BLUR_KERNEL_SUM 35
+
+// How pixels outside the image are taken for the 2-pixel border
+// (a b c d are the first pixels of a row, looking left from a):
+//   NONE      border left untouched, as in image_blur_unopt
+//   CLAMP     a a | a b c d      repeat the edge pixel
+//   MIRROR    c b | a b c d      reflect about the edge pixel
+//   WRAP      y z | a b c d      continue from the opposite edge
+//   CONSTANT  k k | a b c d      a fixed value
+typedef enum {
+    BLUR_BORDER_NONE,
+    BLUR_BORDER_CLAMP,
+    BLUR_BORDER_MIRROR,
+    BLUR_BORDER_WRAP,
+    BLUR_BORDER_CONSTANT
+} blur_border_t;
+
+// Image as row pointers into one contiguous block, so a whole frame can be
+// read or written with a single call through image[0]. NULL on failure.
+static inline unsigned char **allocate_image(int width, int height) {
+    unsigned char **image = (unsigned char**)malloc(height * sizeof(unsigned char*));
+    unsigned char *pixels = (unsigned char*)malloc((size_t)width * height);
+    if (!image || !pixels) {
+        free(image);
+        free(pixels);
+        return NULL;
+    }
+    for (int i = 0; i < height; i++) {
+        image[i] = pixels + (size_t)i * width;
+    }
+    return image;
+}
+
+static inline void free_image(unsigned char **image) {
+    if (image) {
+        free(image[0]);
+        free(image);
+    }
+}
+
+// Same output as image_blur_unopt, whose 5x5 weights are a 5x5 box of ones
+// plus the inner 3x3 box plus the center pixel:
+//
+//   1 1 1 1 1     1 1 1 1 1     0 0 0 0 0     0 0 0 0 0
+//   1 2 2 2 1     1 1 1 1 1     0 1 1 1 0     0 0 0 0 0
+//   1 2 3 2 1  =  1 1 1 1 1  +  0 1 1 1 0  +  0 0 1 0 0
+//   1 2 2 2 1     1 1 1 1 1     0 1 1 1 0     0 0 0 0 0
+//   1 1 1 1 1     1 1 1 1 1     0 0 0 0 0     0 0 0 0 0
+//
+// Both boxes are separable, so each output pixel costs a few additions on
+// running sums instead of 25 multiply-adds: col5/col3 (width ints each)
+// hold the vertical 5- and 3-pixel sums of every column and slide down one
+// row per output row; the horizontal sums slide along the row over them.
+// The integer sums are exactly those of image_blur_unopt, so the output is
+// bit-identical. Rows are read in order, 5 input rows per output row. The
+// 2-pixel border of output is left untouched; blur_border fills it.
+static inline void blur_box(unsigned char **input, unsigned char **output, int width, int height,
+                            int *col5, int *col3) {
+    int offset = BLUR_KERNEL_SIZE / 2;
+    if (width < BLUR_KERNEL_SIZE || height < BLUR_KERNEL_SIZE) {
+        return;
+    }
+
+    // Vertical sums centered on the first output row
+    for (int x = 0; x < width; x++) {
+        col3[x] = input[1][x] + input[2][x] + input[3][x];
+        col5[x] = col3[x] + input[0][x] + input[4][x];
+    }
+
+    for (int y = offset; y < height - offset; y++) {
+        if (y > offset) {
+            const unsigned char *enter5 = input[y + 2];
+            const unsigned char *leave5 = input[y - 3];
+            const unsigned char *enter3 = input[y + 1];
+            const unsigned char *leave3 = input[y - 2];
+            for (int x = 0; x < width; x++) {
+                col5[x] += enter5[x] - leave5[x];
+                col3[x] += enter3[x] - leave3[x];
+            }
+        }
+
+        const unsigned char *center = input[y];
+        unsigned char *out = output[y];
+        int sum5 = col5[0] + col5[1] + col5[2] + col5[3] + col5[4];
+        int sum3 = col3[1] + col3[2] + col3[3];
+        for (int x = offset; x < width - offset; x++) {
+            if (x > offset) {
+                sum5 += col5[x + 2] - col5[x - 3];
+                sum3 += col3[x + 1] - col3[x - 2];
+            }
+            out[x] = (sum5 + sum3 + center[x]) / BLUR_KERNEL_SUM;
+        }
+    }
+}
+
+// Coordinate that stands in for i in a row or column of n pixels; -1 means
+// the constant value
+static inline int blur_border_index(int i, int n, blur_border_t mode) {
+    if (i >= 0 && i < n) {
+        return i;
+    }
+    switch (mode) {
+    case BLUR_BORDER_CLAMP:
+        return i < 0 ? 0 : n - 1;
+    case BLUR_BORDER_MIRROR:
+        if (n == 1) {
+            return 0;
+        }
+        // Period 2n-2: 0 1 .. n-1 n-2 .. 1
+        i %= 2 * n - 2;
+        if (i < 0) {
+            i += 2 * n - 2;
+        }
+        return i < n ? i : 2 * n - 2 - i;
+    case BLUR_BORDER_WRAP:
+        i %= n;
+        return i < 0 ? i + n : i;
+    default:
+        return -1;
+    }
+}
+
+// Fill the output pixels blur_box leaves out (the 2-pixel border, or the
+// whole image if it is smaller than the kernel) with the same weights,
+// taking the pixels outside the image as given by mode. This is a separate
+// pass over O(width + height) pixels, so the interior loop of blur_box
+// stays free of bounds checks and runs at the same speed in every mode.
+static inline void blur_border(unsigned char **input, unsigned char **output, int width, int height,
+                               blur_border_t mode, unsigned char constant) {
+    static const int weights[BLUR_KERNEL_SIZE] = {1, 2, 3, 2, 1};
+    int offset = BLUR_KERNEL_SIZE / 2;
+    int interior = width >= BLUR_KERNEL_SIZE && height >= BLUR_KERNEL_SIZE;
+
+    if (mode == BLUR_BORDER_NONE) {
+        return;
+    }
+    for (int y = 0; y < height; y++) {
+        int border_row = !interior || y < offset || y >= height - offset;
+        // Interior rows only need their first and last two pixels
+        int step = border_row ? 1 : width - 2 * offset + 1;
+        for (int x = 0; x < width; x += (x == offset - 1 ? step : 1)) {
+            int sum = 0;
+            for (int ky = -offset; ky <= offset; ky++) {
+                int sy = blur_border_index(y + ky, height, mode);
+                for (int kx = -offset; kx <= offset; kx++) {
+                    int sx = blur_border_index(x + kx, width, mode);
+                    // Box weights: 1 on the outer ring, 2 inside, 3 in the center
+                    int weight = weights[ky + offset] < weights[kx + offset]
+                                     ? weights[ky + offset] : weights[kx + offset];
+                    int pixel = sy < 0 || sx < 0 ? constant : input[sy][sx];
+                    sum += pixel * weight;
+                }
+            }
+            output[y][x] = sum / BLUR_KERNEL_SUM;
+        }
+    }
+}
+
+// Border mode from its command-line name: "clamp", "mirror", "wrap" or
+// "constant[:<value>]". Returns 0 if the name is invalid.
+static inline int blur_parse_border(const char *name, blur_border_t *mode, unsigned char *value) {
+    static const struct {
+        const char *name;
+        blur_border_t mode;
+    } modes[] = {
+        {"clamp", BLUR_BORDER_CLAMP},
+        {"mirror", BLUR_BORDER_MIRROR},
+        {"wrap", BLUR_BORDER_WRAP},
+    };
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        if (strcmp(name, modes[i].name) == 0) {
+            *mode = modes[i].mode;
+            return 1;
+        }
+    }
+    if (strncmp(name, "constant", 8) == 0) {
+        long k = 0;
+        if (name[8] == ':') {
+            char *end;
+            k = strtol(name + 9, &end, 10);
+            if (name[9] == '\0' || *end != '\0' || k < 0 || k > 255) {
+                return 0;
+            }
+        } else if (name[8] != '\0') {
+            return 0;
+        }
+        *mode = BLUR_BORDER_CONSTANT;
+        *value = (unsigned char)k;
+        return 1;
+    }
+    return 0;
+}
+
+// Straightforward 5x5 blur of the whole image with a bounds check on every
+// tap and the same border handling: the reference image_blur_box checks
+// blur_box and blur_border against (NONE leaves the border untouched)
+static inline void blur_reference(unsigned char **input, unsigned char **output, int width, int height,
+                                  blur_border_t mode, unsigned char constant) {
+    static const int weights[BLUR_KERNEL_SIZE][BLUR_KERNEL_SIZE] = {
+        {1, 1, 1, 1, 1},
+        {1, 2, 2, 2, 1},
+        {1, 2, 3, 2, 1},
+        {1, 2, 2, 2, 1},
+        {1, 1, 1, 1, 1}
+    };
+    int offset = BLUR_KERNEL_SIZE / 2;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int inside = y >= offset && y < height - offset && x >= offset && x < width - offset;
+            if (!inside && mode == BLUR_BORDER_NONE) {
+                continue;
+            }
+            int sum = 0;
+            for (int ky = 0; ky < BLUR_KERNEL_SIZE; ky++) {
+                for (int kx = 0; kx < BLUR_KERNEL_SIZE; kx++) {
+                    int iy = y + ky - offset;
+                    int ix = x + kx - offset;
+                    int pixel;
+                    if (iy >= 0 && iy < height && ix >= 0 && ix < width) {
+                        pixel = input[iy][ix];
+                    } else {
+                        int sy = blur_border_index(iy, height, mode);
+                        int sx = blur_border_index(ix, width, mode);
+                        pixel = sy < 0 || sx < 0 ? constant : input[sy][sx];
+                    }
+                    sum += pixel * weights[ky][kx];
+                }
+            }
+            output[y][x] = sum / BLUR_KERNEL_SUM;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "harness.h"
+#include "gemm.h"
+
+// Cholesky factorization A = L L^T of a symmetric positive definite matrix
+//
+// kernels/Makefile generates one kernel per form from this file
+// (cholesky_unopt, cholesky_blocked, cholesky_recursive, see FACTOR_FORMS
+// there) by defining FORM_UNOPT, FORM_BLOCKED or FORM_RECURSIVE and
+// KERNEL_NAME:
+//   unopt      right-looking, one column at a time over the whole matrix
+//   blocked    right-looking with FACTOR_BLOCK-column panels: an unblocked
+//              factorization of the diagonal block, a triangular solve for
+//              the panel below it and a gemm_blocked update of the lower
+//              half of the trailing matrix
+//   recursive  splits the matrix in half down to RECURSIVE_LEAF columns
+//
+// Only the lower triangle is read and L overwrites it. The trailing update
+// multiplies by L21^T, which gemm_blocked needs row-major: it is packed into
+// a workspace allocated before timing. Each element of L receives the same
+// updates in the same order in every form, so all forms are bit-identical.
+
+#if !defined(FORM_UNOPT) && !defined(FORM_BLOCKED) && !defined(FORM_RECURSIVE)
+#define FORM_UNOPT
+#endif
+#ifndef KERNEL_NAME
+#define KERNEL_NAME "cholesky"
+#endif
+
+#define SIZE 256
+
+// Panel width of the blocked form
+#ifndef FACTOR_BLOCK
+#define FACTOR_BLOCK 32
+#endif
+
+// Largest block the recursive form factors column by column
+#define RECURSIVE_LEAF 8
+
+// Unblocked right-looking Cholesky of the n x n lower triangle
+static void cholesky_unblocked(block_t a, int n) {
+    for (int k = 0; k < n; k++) {
+        double *row_k = block_row(a, k);
+        double d = sqrt(row_k[k]);
+        row_k[k] = d;
+        for (int i = k + 1; i < n; i++) {
+            block_row(a, i)[k] /= d;
+        }
+        for (int i = k + 1; i < n; i++) {
+            double *row_i = block_row(a, i);
+            double l_ik = row_i[k];
+            for (int j = k + 1; j <= i; j++) {
+                row_i[j] -= l_ik * block_row(a, j)[k];
+            }
+        }
+    }
+}
+
+// B (m x n) = B L^-T, L lower triangular n x n
+static void trsm_lower_transpose(block_t l, block_t b, int m, int n) {
+    for (int i = 0; i < m; i++) {
+        double *row_i = block_row(b, i);
+        for (int j = 0; j < n; j++) {
+            const double *l_j = block_row(l, j);
+            double x = row_i[j];
+            for (int k = 0; k < j; k++) {
+                x -= row_i[k] * l_j[k];
+            }
+            row_i[j] = x / l_j[j];
+        }
+    }
+}
+
+// Lower triangle of C (m x m) -= A A^T, A m x k. work holds A^T (k x m).
+// Block rows of C are updated up to and including their diagonal block; the
+// upper part of the diagonal blocks is updated too but never read.
+static void syrk_lower(block_t a, block_t c, int m, int k, double *work) {
+    block_t at = {work, m};
+    for (int i = 0; i < m; i++) {
+        const double *row_i = block_row(a, i);
+        for (int p = 0; p < k; p++) {
+            block_row(at, p)[i] = row_i[p];
+        }
+    }
+    for (int i0 = 0; i0 < m; i0 += FACTOR_BLOCK) {
+        int ib = i0 + FACTOR_BLOCK < m ? FACTOR_BLOCK : m - i0;
+        gemm_blocked(block_at(a, i0, 0), at, block_at(c, i0, 0), ib, i0 + ib, k, -1.0);
+    }
+}
+
+void cholesky_blocked(block_t a, int n, double *work) {
+    for (int k0 = 0; k0 < n; k0 += FACTOR_BLOCK) {
+        int kb = k0 + FACTOR_BLOCK < n ? FACTOR_BLOCK : n - k0;
+        int rest = n - k0 - kb;
+
+        cholesky_unblocked(block_at(a, k0, k0), kb);
+        trsm_lower_transpose(block_at(a, k0, k0), block_at(a, k0 + kb, k0), rest, kb);
+        syrk_lower(block_at(a, k0 + kb, k0), block_at(a, k0 + kb, k0 + kb), rest, kb, work);
+    }
+}
+
+void cholesky_recursive(block_t a, int n, double *work) {
+    if (n <= RECURSIVE_LEAF) {
+        cholesky_unblocked(a, n);
+        return;
+    }
+    int n1 = n / 2;
+    int n2 = n - n1;
+
+    cholesky_recursive(a, n1, work);
+    trsm_lower_transpose(a, block_at(a, n1, 0), n2, n1);
+    syrk_lower(block_at(a, n1, 0), block_at(a, n1, n1), n2, n1, work);
+    cholesky_recursive(block_at(a, n1, n1), n2, work);
+}
+
+void cholesky(block_t a, int n, double *work) {
+#if defined(FORM_BLOCKED)
+    cholesky_blocked(a, n, work);
+#elif defined(FORM_RECURSIVE)
+    cholesky_recursive(a, n, work);
+#else
+    (void)work;
+    cholesky_unblocked(a, n);
+#endif
+}
+
+// Symmetric with entries in [0, 1) and n added to the diagonal: diagonally
+// dominant, hence positive definite
+void initialize_matrix(block_t a, int n) {
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j <= i; j++) {
+            double value = (double)(rand() % 100) / 100.0;
+            block_row(a, i)[j] = value;
+            block_row(a, j)[i] = value;
+        }
+        block_row(a, i)[i] += n;
+    }
+}
+
+// Sum of the lower triangle (L)
+double factor_checksum(block_t a, int n) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j <= i; j++) {
+            sum += block_row(a, i)[j];
+        }
+    }
+    return sum;
+}
+
+typedef struct {
+    block_t a;
+    const double *input;
+    double *work;
+    int n;
+} cholesky_ctx_t;
+
+static void run_factor(void *p) {
+    cholesky_ctx_t *ctx = (cholesky_ctx_t*)p;
+    cholesky(ctx->a, ctx->n, ctx->work);
+}
+
+// The factorization works in place: restore the input before every run
+static void reset_matrix(void *p) {
+    cholesky_ctx_t *ctx = (cholesky_ctx_t*)p;
+    memcpy(ctx->a.data, ctx->input, (size_t)ctx->n * ctx->n * sizeof(double));
+}
+
+// Sum of L for the default seed
+static const harness_ref_t references[] = {
+    {64, 622.07442538391354},
+    {128, 1759.4888900347253},
+    {256, 4972.8127475489509},
+    {512, 14071.575322837336},
+    {0, 0.0}
+};
+
+int main(int argc, char **argv) {
+    harness_t h;
+    harness_init(&h, KERNEL_NAME, argc, argv, SIZE);
+    int n = h.size;
+
+    srand(h.seed);  // Fixed seed for reproducible results
+
+    size_t elements = (size_t)n * n;
+    double *input = (double*)malloc(elements * sizeof(double));
+    double *data = (double*)malloc(elements * sizeof(double));
+    double *work = (double*)malloc(elements * sizeof(double));   // A^T of syrk_lower
+    double **rows = (double**)malloc(n * sizeof(double*));
+    if (!input || !data || !work || !rows) {
+        fprintf(stderr, "%s: memory allocation failed\n", KERNEL_NAME);
+        return 1;
+    }
+    block_t input_block = {input, n};
+    initialize_matrix(input_block, n);
+
+    cholesky_ctx_t ctx = {{data, n}, input, work, n};
+    harness_run(&h, run_factor, reset_matrix, &ctx);
+
+    // The upper triangle holds input values (or scratch in the blocked
+    // forms): clear it so the dump is L alone
+    for (int i = 0; i < n; i++) {
+        rows[i] = block_row(ctx.a, i);
+        memset(rows[i] + i + 1, 0, (n - i - 1) * sizeof(double));
+    }
+    harness_check(&h, factor_checksum(ctx.a, n), references, 1e-9);
+    harness_dump(&h, HARNESS_F64, (void *const *)rows, n, 0, n);
+
+    printf("Cholesky factorization completed in %f seconds\n", harness_best_time(&h));
+    printf("L[0][0] = %f, L[n-1][n-1] = %f\n", data[0], data[elements - 1]);
+
+    free(input);
+    free(data);
+    free(work);
+    free(rows);
+
+    return harness_finish(&h);
+}
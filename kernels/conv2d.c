@@ -0,0 +1,258 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "harness.h"
+#include "gemm.h"
+
+// Multi-channel 2D convolution layer
+//
+// out[co][y][x] = sum over ci, ky, kx of w[co][ci][ky][kx] *
+//                 in[ci][y + ky - K/2][x + kx - K/2]
+// on size x size images with zero padding ("same" output size), C_in =
+// CHANNELS input and C_out = OUT_CHANNELS output channels (default: C_in)
+// and a K x K kernel (CONV_K, odd, default 3).
+//
+// kernels/Makefile generates one kernel per form and channel count from
+// this file (conv2d_<form>_c<channels>, see CONV_FORMS and CONV_CHANNELS
+// there) by defining FORM_UNOPT, FORM_DIRECT or FORM_IM2COL, CHANNELS
+// and KERNEL_NAME (OUT_CHANNELS and CONV_K come from CFLAGS if set):
+//   unopt   one output pixel at a time, bounds-checked window
+//   direct  output in tiles of CONV_TILE rows: every weight is applied to a
+//           whole tile row by row, and the input rows of the tile are reused
+//           by all output channels
+//   im2col  copies every K x K x C_in input window into a column of a
+//           (C_in K^2) x (size^2) matrix, then multiplies the weights by it
+//           with gemm_blocked (gemm.h); the matrix is K^2 times the input
+//
+// All forms sum each output in the same order (ci, ky, kx) and im2col's
+// padding adds exact zeros, so the results are bit-identical.
+
+#if !defined(FORM_UNOPT) && !defined(FORM_DIRECT) && !defined(FORM_IM2COL)
+#define FORM_UNOPT
+#endif
+#ifndef CHANNELS
+#define CHANNELS 16
+#endif
+#ifndef OUT_CHANNELS
+#define OUT_CHANNELS CHANNELS
+#endif
+#ifndef KERNEL_NAME
+#define KERNEL_NAME "conv2d"
+#endif
+
+#define SIZE 32
+
+#ifndef CONV_K
+#define CONV_K 3
+#endif
+#if CONV_K % 2 == 0
+#error "CONV_K must be odd for a same-size output"
+#endif
+#define K CONV_K
+
+// Output rows per tile of the direct form
+#ifndef CONV_TILE
+#define CONV_TILE 8
+#endif
+
+typedef struct {
+    double *in;                  // [C_in][size][size]
+    double *weights;             // [C_out][C_in][K][K]
+    double *out;                 // [C_out][size][size]
+    double *columns;             // im2col matrix, [C_in K K][size size]
+    int size;
+} conv_ctx_t;
+
+#define IN(ctx, c, y, x) (ctx)->in[((size_t)(c) * (ctx)->size + (y)) * (ctx)->size + (x)]
+#define OUT(ctx, c, y, x) (ctx)->out[((size_t)(c) * (ctx)->size + (y)) * (ctx)->size + (x)]
+#define WEIGHT(ctx, co, ci, ky, kx) (ctx)->weights[(((size_t)(co) * CHANNELS + (ci)) * K + (ky)) * K + (kx)]
+
+void conv_unopt(conv_ctx_t *ctx) {
+    int n = ctx->size;
+    for (int co = 0; co < OUT_CHANNELS; co++) {
+        for (int y = 0; y < n; y++) {
+            for (int x = 0; x < n; x++) {
+                double sum = 0.0;
+                for (int ci = 0; ci < CHANNELS; ci++) {
+                    for (int ky = 0; ky < K; ky++) {
+                        for (int kx = 0; kx < K; kx++) {
+                            int iy = y + ky - K / 2;
+                            int ix = x + kx - K / 2;
+                            if (iy >= 0 && iy < n && ix >= 0 && ix < n) {
+                                sum += WEIGHT(ctx, co, ci, ky, kx) * IN(ctx, ci, iy, ix);
+                            }
+                        }
+                    }
+                }
+                OUT(ctx, co, y, x) = sum;
+            }
+        }
+    }
+}
+
+void conv_direct(conv_ctx_t *ctx) {
+    int n = ctx->size;
+    memset(ctx->out, 0, (size_t)OUT_CHANNELS * n * n * sizeof(double));
+    for (int y0 = 0; y0 < n; y0 += CONV_TILE) {
+        int y1 = y0 + CONV_TILE < n ? y0 + CONV_TILE : n;
+        for (int co = 0; co < OUT_CHANNELS; co++) {
+            for (int ci = 0; ci < CHANNELS; ci++) {
+                for (int ky = 0; ky < K; ky++) {
+                    for (int kx = 0; kx < K; kx++) {
+                        double w = WEIGHT(ctx, co, ci, ky, kx);
+                        // Output columns whose input column x + kx - K/2 exists
+                        int x0 = K / 2 - kx > 0 ? K / 2 - kx : 0;
+                        int x1 = n + K / 2 - kx < n ? n + K / 2 - kx : n;
+                        for (int y = y0; y < y1; y++) {
+                            int iy = y + ky - K / 2;
+                            if (iy < 0 || iy >= n) {
+                                continue;
+                            }
+                            double *restrict out_row = &OUT(ctx, co, y, 0);
+                            const double *restrict in_row = &IN(ctx, ci, iy, 0);
+                            for (int x = x0; x < x1; x++) {
+                                out_row[x] += w * in_row[x + kx - K / 2];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void conv_im2col(conv_ctx_t *ctx) {
+    int n = ctx->size;
+    size_t pixels = (size_t)n * n;
+    for (int ci = 0; ci < CHANNELS; ci++) {
+        for (int ky = 0; ky < K; ky++) {
+            for (int kx = 0; kx < K; kx++) {
+                double *row = ctx->columns + ((size_t)(ci * K + ky) * K + kx) * pixels;
+                for (int y = 0; y < n; y++) {
+                    int iy = y + ky - K / 2;
+                    for (int x = 0; x < n; x++) {
+                        int ix = x + kx - K / 2;
+                        row[y * n + x] = iy >= 0 && iy < n && ix >= 0 && ix < n ?
+                                         IN(ctx, ci, iy, ix) : 0.0;
+                    }
+                }
+            }
+        }
+    }
+
+    block_t weights = {ctx->weights, CHANNELS * K * K};
+    block_t columns = {ctx->columns, (int)pixels};
+    block_t out = {ctx->out, (int)pixels};
+    memset(ctx->out, 0, OUT_CHANNELS * pixels * sizeof(double));
+    gemm_blocked(weights, columns, out, OUT_CHANNELS, (int)pixels, CHANNELS * K * K, 1.0);
+}
+
+static void run_conv(void *p) {
+    conv_ctx_t *ctx = (conv_ctx_t*)p;
+#if defined(FORM_DIRECT)
+    conv_direct(ctx);
+#elif defined(FORM_IM2COL)
+    conv_im2col(ctx);
+#else
+    conv_unopt(ctx);
+#endif
+}
+
+// Pixel-like inputs in [0, 1] and small positive weights
+void initialize_layer(conv_ctx_t *ctx) {
+    size_t elements = (size_t)CHANNELS * ctx->size * ctx->size;
+    for (size_t i = 0; i < elements; i++) {
+        ctx->in[i] = (double)(rand() % 256) / 255.0;
+    }
+    for (size_t i = 0; i < (size_t)OUT_CHANNELS * CHANNELS * K * K; i++) {
+        ctx->weights[i] = (double)(rand() % 100) / 1000.0;
+    }
+}
+
+double output_checksum(const conv_ctx_t *ctx) {
+    size_t elements = (size_t)OUT_CHANNELS * ctx->size * ctx->size;
+    double sum = 0.0;
+    for (size_t i = 0; i < elements; i++) {
+        sum += ctx->out[i];
+    }
+    return sum;
+}
+
+// Sum of all outputs for the default seed, per channel count (3x3 kernel,
+// C_in = C_out only)
+static const harness_ref_t references[] = {
+#if CONV_K != 3 || OUT_CHANNELS != CHANNELS
+#elif CHANNELS == 4
+    {16, 790.3468039215685},
+    {32, 3438.0877176470635},
+    {64, 14380.53530196083},
+#elif CHANNELS == 16
+    {16, 13405.118247058816},
+    {32, 56566.898635294405},
+    {64, 231090.00574509896},
+#elif CHANNELS == 64
+    {16, 214878.45701960768},
+    {32, 896790.9065176572},
+    {64, 3644445.50123531},
+#endif
+    {0, 0.0}
+};
+
+int main(int argc, char **argv) {
+    harness_t h;
+    harness_init(&h, KERNEL_NAME, argc, argv, SIZE);
+    int n = h.size;
+
+    srand(h.seed);  // Fixed seed for reproducible results
+
+    size_t image_bytes = (size_t)CHANNELS * n * n * sizeof(double);
+    size_t out_bytes = (size_t)OUT_CHANNELS * n * n * sizeof(double);
+    size_t weight_bytes = (size_t)OUT_CHANNELS * CHANNELS * K * K * sizeof(double);
+    size_t column_bytes = (size_t)K * K * image_bytes;
+    conv_ctx_t ctx;
+    ctx.size = n;
+    ctx.in = (double*)malloc(image_bytes);
+    ctx.weights = (double*)malloc(weight_bytes);
+    ctx.out = (double*)malloc(out_bytes);
+#if defined(FORM_IM2COL)
+    ctx.columns = (double*)malloc(column_bytes);
+    int columns_ok = ctx.columns != NULL;
+#else
+    ctx.columns = NULL;
+    int columns_ok = 1;
+#endif
+    if (!ctx.in || !ctx.weights || !ctx.out || !columns_ok) {
+        fprintf(stderr, "%s: memory allocation failed\n", KERNEL_NAME);
+        return 1;
+    }
+    initialize_layer(&ctx);
+
+    harness_run(&h, run_conv, NULL, &ctx);
+    harness_check(&h, output_checksum(&ctx), references, 1e-9);
+    double *out = ctx.out;
+    harness_dump(&h, HARNESS_F64, (void *const *)&out, 1, 0, OUT_CHANNELS * n * n);
+
+    // Data each form touches: the layer's input, weights and output, plus
+    // im2col's column matrix
+    size_t layer_bytes = image_bytes + out_bytes + weight_bytes;
+    printf("Layer: %dx%d, %d -> %d channels, %dx%d kernel, %.0f M multiply-adds\n",
+           n, n, CHANNELS, OUT_CHANNELS, K, K, (double)OUT_CHANNELS * CHANNELS * K * K * n * n / 1e6);
+    printf("Memory: input %.2f MB, weights %.2f MB, output %.2f MB",
+           image_bytes / 1e6, weight_bytes / 1e6, out_bytes / 1e6);
+#if defined(FORM_IM2COL)
+    printf(", im2col columns %.2f MB (%.1fx the layer)\n",
+           column_bytes / 1e6, (double)column_bytes / layer_bytes);
+#else
+    printf(" (im2col would add %.2f MB, %.1fx the layer)\n",
+           column_bytes / 1e6, (double)column_bytes / layer_bytes);
+#endif
+    printf("Convolution completed in %f seconds\n", harness_best_time(&h));
+
+    free(ctx.in);
+    free(ctx.weights);
+    free(ctx.out);
+    free(ctx.columns);
+
+    return harness_finish(&h);
+}
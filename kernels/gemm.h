@@ -0,0 +1,61 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+// Blocked matrix multiply-update on strided row-major blocks
+//
+// The tiled ikj loop nest of matrix_mult_ikj_t32, generalized to
+// rectangular blocks of larger matrices: the base case of
+// matrix_mult_strassen and the trailing update of the LU and Cholesky
+// kernels. Every element of C receives its products one at a time in
+// increasing k, so an algorithm that applies the same updates element by
+// element rounds identically.
+//
+// The functions are static inline so every kernel compiles its own copy, as
+// with blur.h.
+
+#include <stddef.h>
+
+#ifndef GEMM_TILE
+#define GEMM_TILE 32
+#endif
+
+typedef struct {
+    double *data;
+    int ld;                      // Row stride in elements
+} block_t;
+
+// Sub-block starting at row i, column j
+static inline block_t block_at(block_t m, int i, int j) {
+    block_t b = {m.data + (size_t)i * m.ld + j, m.ld};
+    return b;
+}
+
+static inline double *block_row(block_t m, int i) {
+    return m.data + (size_t)i * m.ld;
+}
+
+// C (m x n) += sign * A (m x k) * B (k x n); sign is 1.0 or -1.0
+static inline void gemm_blocked(block_t a, block_t b, block_t c, int m, int n, int k,
+                                double sign) {
+    for (int ii = 0; ii < m; ii += GEMM_TILE) {
+        int i_end = ii + GEMM_TILE < m ? ii + GEMM_TILE : m;
+        for (int kk = 0; kk < k; kk += GEMM_TILE) {
+            int k_end = kk + GEMM_TILE < k ? kk + GEMM_TILE : k;
+            for (int jj = 0; jj < n; jj += GEMM_TILE) {
+                int j_end = jj + GEMM_TILE < n ? jj + GEMM_TILE : n;
+                for (int i = ii; i < i_end; i++) {
+                    double *restrict rc = block_row(c, i);
+                    for (int p = kk; p < k_end; p++) {
+                        double a_ip = sign * block_row(a, i)[p];
+                        const double *restrict rb = block_row(b, p);
+                        for (int j = jj; j < j_end; j++) {
+                            rc[j] += a_ip * rb[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif
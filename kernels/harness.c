@@ -0,0 +1,290 @@
+#include "harness.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+// ROI_PAUSE/ROI_RESUME leave the resets between timed repeats out of the
+// ROI. gem5 cannot pause its statistics, so there they end the current
+// stats.txt block and start the next one.
+#ifdef GEM5_ROI
+#include <gem5/m5ops.h>
+#define ROI_BEGIN() m5_reset_stats(0, 0)
+#define ROI_END() m5_dump_stats(0, 0)
+#define ROI_PAUSE() m5_dump_stats(0, 0)
+#define ROI_RESUME() m5_reset_stats(0, 0)
+#elif defined(REUSE_PROFILE)
+#include "reuse_profile.h"
+#define ROI_BEGIN() reuse_profile_begin()
+#define ROI_END() reuse_profile_end()
+#define ROI_PAUSE() reuse_profile_pause()
+#define ROI_RESUME() reuse_profile_resume()
+#else
+#define ROI_BEGIN() ((void)0)
+#define ROI_END() ((void)0)
+#define ROI_PAUSE() ((void)0)
+#define ROI_RESUME() ((void)0)
+#endif
+
+static void usage(const char *prog, int default_size) {
+    printf("Usage: %s [options]\n", prog);
+    printf("  --size <n>       Problem size (default: %d)\n", default_size);
+    printf("  --warmup <n>     Untimed iterations before measuring (default: 0)\n");
+    printf("  --repeat <n>     Timed iterations (default: 1)\n");
+    printf("  --seed <n>       Random seed for input data (default: %d)\n", HARNESS_DEFAULT_SEED);
+    printf("  --json <file>    Write results as JSON (\"-\" for stdout)\n");
+    printf("  --dump <file>    Write the full output for verification\n");
+}
+
+static long parse_count(const char *prog, const char *option, const char *value, long min) {
+    char *end;
+    long n = value ? strtol(value, &end, 10) : 0;
+    if (!value || *end != '\0' || n < min) {
+        fprintf(stderr, "%s: %s expects an integer >= %ld\n", prog, option, min);
+        exit(2);
+    }
+    return n;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void harness_init(harness_t *h, const char *name, int argc, char **argv, int default_size) {
+    memset(h, 0, sizeof(*h));
+    h->name = name;
+    h->size = default_size;
+    h->warmup = 0;
+    h->repeats = 1;
+    h->seed = HARNESS_DEFAULT_SEED;
+    h->verified = -1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--size") == 0) {
+            h->size = (int)parse_count(argv[0], argv[i], value, 1);
+            i++;
+        } else if (strcmp(argv[i], "--warmup") == 0) {
+            h->warmup = (int)parse_count(argv[0], argv[i], value, 0);
+            i++;
+        } else if (strcmp(argv[i], "--repeat") == 0) {
+            h->repeats = (int)parse_count(argv[0], argv[i], value, 1);
+            i++;
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            h->seed = (unsigned)parse_count(argv[0], argv[i], value, 0);
+            i++;
+        } else if (strcmp(argv[i], "--json") == 0 && value) {
+            h->json_path = value;
+            i++;
+        } else if (strcmp(argv[i], "--dump") == 0 && value) {
+            h->dump_path = value;
+            i++;
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            usage(argv[0], default_size);
+            exit(0);
+        } else {
+            fprintf(stderr, "%s: invalid option '%s'\n", argv[0], argv[i]);
+            usage(argv[0], default_size);
+            exit(2);
+        }
+    }
+
+    // Sections are appended by harness_dump, so start from an empty file
+    if (h->dump_path) {
+        FILE *f = fopen(h->dump_path, "wb");
+        if (!f) {
+            fprintf(stderr, "%s: cannot write %s\n", argv[0], h->dump_path);
+            exit(1);
+        }
+        fclose(f);
+    }
+
+    h->times = (double*)calloc(h->repeats, sizeof(double));
+    if (!h->times) {
+        fprintf(stderr, "%s: memory allocation failed\n", argv[0]);
+        exit(1);
+    }
+    perf_counters_open(&h->counters);
+}
+
+void harness_run(harness_t *h, void (*kernel)(void *), void (*reset)(void *), void *ctx) {
+    for (int i = 0; i < h->warmup; i++) {
+        if (reset) {
+            reset(ctx);
+        }
+        kernel(ctx);
+    }
+
+    // The counters and the ROI cover the kernel calls only, like the times
+    h->roi_repeats = reset && h->repeats > 1 ? 1 : h->repeats;
+    double total = 0.0;
+    for (int i = 0; i < h->repeats; i++) {
+        if (reset) {
+            if (i > 0) {
+                perf_counters_pause(&h->counters);
+                ROI_PAUSE();
+            }
+            reset(ctx);
+            if (i > 0) {
+                ROI_RESUME();
+                perf_counters_resume(&h->counters);
+            }
+        }
+        if (i == 0) {
+            ROI_BEGIN();
+            perf_counters_start(&h->counters);
+        }
+
+        double start = now_seconds();
+        kernel(ctx);
+        h->times[i] = now_seconds() - start;
+        total += h->times[i];
+    }
+
+    perf_counters_stop(&h->counters);
+    ROI_END();
+    perf_counters_report(&h->counters, total);
+}
+
+void harness_check(harness_t *h, double checksum, const harness_ref_t *refs, double tolerance) {
+    h->checksum = checksum;
+    h->has_reference = 0;
+    h->verified = -1;
+
+    // References are only valid for the default input data
+    if (h->seed != HARNESS_DEFAULT_SEED) {
+        return;
+    }
+    for (const harness_ref_t *ref = refs; ref && ref->size != 0; ref++) {
+        if (ref->size == h->size) {
+            h->reference = ref->checksum;
+            h->has_reference = 1;
+            double scale = fabs(ref->checksum) > 1.0 ? fabs(ref->checksum) : 1.0;
+            h->verified = fabs(checksum - ref->checksum) <= tolerance * scale;
+            return;
+        }
+    }
+}
+
+void harness_dump(harness_t *h, harness_type_t type, void *const *rows,
+                  int nrows, int col_start, int ncols) {
+    static const char *type_names[] = {"u8", "f64"};
+    static const size_t type_sizes[] = {1, sizeof(double)};
+
+    if (!h->dump_path) {
+        return;
+    }
+
+    FILE *f = fopen(h->dump_path, "ab");
+    if (!f) {
+        fprintf(stderr, "Warning: cannot write dump to %s\n", h->dump_path);
+        return;
+    }
+
+    // A region past the edges (e.g. the interior of an image smaller than
+    // the stencil) is empty, not negative
+    if (nrows < 0 || ncols < 0) {
+        nrows = 0;
+        ncols = 0;
+    }
+
+    // Section: text header "<type> <count>\n" followed by raw native-endian data
+    size_t elem = type_sizes[type];
+    fprintf(f, "%s %ld\n", type_names[type], (long)nrows * ncols);
+    for (int i = 0; i < nrows; i++) {
+        fwrite((const char*)rows[i] + (size_t)col_start * elem, elem, ncols, f);
+    }
+    fclose(f);
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+double harness_best_time(const harness_t *h) {
+    double best = h->times[0];
+    for (int i = 1; i < h->repeats; i++) {
+        if (h->times[i] < best) {
+            best = h->times[i];
+        }
+    }
+    return best;
+}
+
+double harness_median_time(const harness_t *h) {
+    double *sorted = (double*)malloc(h->repeats * sizeof(double));
+    memcpy(sorted, h->times, h->repeats * sizeof(double));
+    qsort(sorted, h->repeats, sizeof(double), compare_doubles);
+    double median = h->repeats % 2 ? sorted[h->repeats / 2]
+                                   : (sorted[h->repeats / 2 - 1] + sorted[h->repeats / 2]) / 2.0;
+    free(sorted);
+    return median;
+}
+
+static const char *verification_status(const harness_t *h) {
+    return h->verified == 1 ? "ok" : h->verified == 0 ? "MISMATCH" : "unverified";
+}
+
+static void write_json(const harness_t *h, FILE *f) {
+    fprintf(f, "{\n");
+    fprintf(f, "  \"kernel\": \"%s\",\n", h->name);
+    fprintf(f, "  \"size\": %d,\n", h->size);
+    fprintf(f, "  \"seed\": %u,\n", h->seed);
+    fprintf(f, "  \"warmup\": %d,\n", h->warmup);
+    fprintf(f, "  \"repeats\": %d,\n", h->repeats);
+    fprintf(f, "  \"times_s\": [");
+    for (int i = 0; i < h->repeats; i++) {
+        fprintf(f, "%s%.9f", i ? ", " : "", h->times[i]);
+    }
+    fprintf(f, "],\n");
+    fprintf(f, "  \"best_s\": %.9f,\n", harness_best_time(h));
+    fprintf(f, "  \"median_s\": %.9f,\n", harness_median_time(h));
+    fprintf(f, "  \"checksum\": %.17g,\n", h->checksum);
+    if (h->has_reference) {
+        fprintf(f, "  \"reference\": %.17g,\n", h->reference);
+    } else {
+        fprintf(f, "  \"reference\": null,\n");
+    }
+    fprintf(f, "  \"verification\": \"%s\"\n", verification_status(h));
+    fprintf(f, "}\n");
+}
+
+int harness_finish(harness_t *h) {
+    printf("%s: size %d, %d warmup + %d timed runs, best %f s, median %f s\n",
+           h->name, h->size, h->warmup, h->repeats,
+           harness_best_time(h), harness_median_time(h));
+    if (h->has_reference) {
+        printf("Full checksum: %.10g (reference %.10g): %s\n",
+               h->checksum, h->reference, verification_status(h));
+    } else {
+        printf("Full checksum: %.10g (no reference for this size/seed)\n", h->checksum);
+    }
+#ifdef GEM5_ROI
+    // run_cache_sweep.sh records this in the run manifest
+    printf("gem5 ROI: %d timed runs per stats dump\n", h->roi_repeats);
+#endif
+
+    if (h->json_path) {
+        FILE *f = strcmp(h->json_path, "-") == 0 ? stdout : fopen(h->json_path, "w");
+        if (f) {
+            write_json(h, f);
+            if (f != stdout) {
+                fclose(f);
+            }
+        } else {
+            fprintf(stderr, "Warning: cannot write JSON to %s\n", h->json_path);
+        }
+    }
+
+    perf_counters_close(&h->counters);
+    free(h->times);
+    h->times = NULL;
+
+    return h->verified == 0 ? 1 : 0;
+}
@@ -0,0 +1,88 @@
+#ifndef HARNESS_H
+#define HARNESS_H
+
+// Common benchmark harness for the kernels
+//
+// Provides warmup and repeat loops, wall-clock timing, full-output checksum
+// validation against stored references, gem5 ROI markers, command-line
+// parsing and JSON output, so every kernel produces comparable,
+// machine-readable measurements.
+//
+// Command-line options understood by every kernel:
+//   --size <n>       Problem size (kernel-specific meaning, default per kernel)
+//   --warmup <n>     Untimed iterations before measuring (default: 0)
+//   --repeat <n>     Timed iterations (default: 1)
+//   --seed <n>       Random seed for input data (default: 42)
+//   --json <file>    Write results as JSON ("-" for stdout)
+//   --dump <file>    Write the full kernel output for scripts/verify_kernels.py
+//
+// Building with -DGEM5_ROI (and linking libm5) resets gem5's statistics
+// when the first timed iteration starts and dumps them when the last one
+// ends, so the first stats.txt block covers only the measured region.
+// gem5 cannot pause its statistics, so for kernels with a reset function
+// every timed iteration gets its own block and the resets between them
+// fall outside all blocks.
+// Building with -DREUSE_PROFILE profiles the same region (see
+// reuse_profile.c), and perf counters count it (see perf_counters.h).
+
+#include "perf_counters.h"
+
+#define HARNESS_DEFAULT_SEED 42
+
+// Element types of dumped outputs
+typedef enum {
+    HARNESS_U8,
+    HARNESS_F64
+} harness_type_t;
+
+// Reference checksum for one problem size (default seed)
+typedef struct {
+    int size;
+    double checksum;
+} harness_ref_t;
+
+typedef struct {
+    const char *name;
+    int size;
+    int warmup;
+    int repeats;
+    unsigned seed;
+    const char *json_path;       // NULL if no JSON output was requested
+    const char *dump_path;       // NULL if no output dump was requested
+
+    double *times;               // Per-repeat wall-clock time in seconds
+    int roi_repeats;             // Timed repeats per ROI segment (stats dump)
+    double checksum;
+    double reference;
+    int has_reference;
+    int verified;                // 1 ok, 0 mismatch, -1 no reference
+    perf_counters_t counters;
+} harness_t;
+
+// Parse the command line. Exits with a usage message on invalid options.
+void harness_init(harness_t *h, const char *name, int argc, char **argv, int default_size);
+
+// Run reset+kernel for the warmup iterations, then for each timed repeat:
+// reset (untimed, outside the ROI and perf counters), then kernel (timed).
+// reset may be NULL.
+void harness_run(harness_t *h, void (*kernel)(void *), void (*reset)(void *), void *ctx);
+
+// Compare a full-output checksum against the reference for h->size.
+// refs is terminated by an entry with size 0. tolerance is relative.
+void harness_check(harness_t *h, double checksum, const harness_ref_t *refs, double tolerance);
+
+// Append a 2D region (rows[0..nrows), columns [col_start, col_start+ncols))
+// to the --dump file as one section; a no-op without --dump. 1D arrays are
+// dumped by passing their address with nrows = 1. A negative count dumps an
+// empty section.
+void harness_dump(harness_t *h, harness_type_t type, void *const *rows,
+                  int nrows, int col_start, int ncols);
+
+double harness_best_time(const harness_t *h);
+double harness_median_time(const harness_t *h);
+
+// Print the summary line, write JSON if requested and release resources.
+// Returns the process exit code: nonzero if verification failed.
+int harness_finish(harness_t *h);
+
+#endif
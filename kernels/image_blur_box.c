@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "harness.h"
+#include "blur.h"
+
+#define WIDTH 512
+#define HEIGHT 512
+
+// Box-decomposed image blur: same output as image_blur_unopt from running
+// box sums, about ten additions per pixel instead of 25 multiply-adds
+// (see blur_box in blur.h). Unlike image_blur_unopt it also fills the
+// border (blur_border), so the whole output is defined and checked:
+// --border selects how pixels outside the image are taken (default: clamp),
+// and every run is compared pixel by pixel with blur_reference. --border
+// none leaves the border out as image_blur_unopt does, so the interior can
+// be compared with image_blur_unopt (scripts/verify_kernels.py does).
+
+// Same pixel values as image_blur_unopt
+void initialize_image(unsigned char **image, int width, int height) {
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            image[y][x] = (x + y) % 256;
+        }
+    }
+}
+
+// Sum of the pixels at least margin pixels from the edges (0: all of them)
+double image_checksum(unsigned char **image, int width, int height, int margin) {
+    double sum = 0.0;
+    for (int y = margin; y < height - margin; y++) {
+        for (int x = margin; x < width - margin; x++) {
+            sum += image[y][x];
+        }
+    }
+    return sum;
+}
+
+typedef struct {
+    unsigned char **input, **output;
+    int *col5, *col3;
+    int width, height;
+    blur_border_t border;
+    unsigned char border_value;
+} blur_ctx_t;
+
+static void run_blur(void *p) {
+    blur_ctx_t *ctx = (blur_ctx_t*)p;
+    blur_box(ctx->input, ctx->output, ctx->width, ctx->height, ctx->col5, ctx->col3);
+    blur_border(ctx->input, ctx->output, ctx->width, ctx->height, ctx->border, ctx->border_value);
+}
+
+// Checksums of square images (size = width = height) with the default
+// clamp border; other modes are checked against blur_reference only
+static const harness_ref_t references[] = {
+    {128, 2080266.0},
+    {256, 8353840.0},
+    {512, 33417296.0},
+    {1024, 133673104.0},
+    {0, 0.0}
+};
+
+// Interior checksums (--border none), as image_blur_unopt
+static const harness_ref_t interior_references[] = {
+    {128, 1952752.0},
+    {256, 8096088.0},
+    {512, 32899448.0},
+    {1024, 132635064.0},
+    {0, 0.0}
+};
+
+// Options of this kernel, removed from argv before harness_init
+static void parse_border_option(int *argc, char **argv, blur_border_t *mode, unsigned char *value) {
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--border") == 0) {
+            if (i + 1 < *argc && strcmp(argv[i + 1], "none") == 0) {
+                *mode = BLUR_BORDER_NONE;
+            } else if (i + 1 >= *argc || !blur_parse_border(argv[i + 1], mode, value)) {
+                fprintf(stderr, "%s: --border expects none, clamp, mirror, wrap or constant[:<0-255>]\n",
+                        argv[0]);
+                exit(2);
+            }
+            i++;
+        } else {
+            if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+                printf("image_blur_box options:\n");
+                printf("  --border <mode>    none, clamp, mirror, wrap or constant[:<0-255>] (default: clamp)\n");
+            }
+            argv[kept++] = argv[i];
+        }
+    }
+    *argc = kept;
+    argv[kept] = NULL;
+}
+
+// Compare the output with blur_reference at least margin pixels from the
+// edges; prints the first differing pixel
+static int matches_reference(const blur_ctx_t *ctx, unsigned char **expected, int margin) {
+    for (int y = margin; y < ctx->height - margin; y++) {
+        for (int x = margin; x < ctx->width - margin; x++) {
+            if (ctx->output[y][x] != expected[y][x]) {
+                fprintf(stderr, "image_blur_box: output[%d][%d] = %d, reference %d\n",
+                        y, x, ctx->output[y][x], expected[y][x]);
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    blur_border_t border = BLUR_BORDER_CLAMP;
+    unsigned char border_value = 0;
+    parse_border_option(&argc, argv, &border, &border_value);
+
+    harness_t h;
+    harness_init(&h, "image_blur_box", argc, argv, WIDTH);
+    int width = h.size;
+    int height = h.size;
+
+    unsigned char **input = allocate_image(width, height);
+    unsigned char **output = allocate_image(width, height);
+    unsigned char **expected = allocate_image(width, height);
+    int *col5 = (int*)malloc(width * sizeof(int));
+    int *col3 = (int*)malloc(width * sizeof(int));
+    if (!input || !output || !expected || !col5 || !col3) {
+        fprintf(stderr, "image_blur_box: memory allocation failed\n");
+        return 1;
+    }
+
+    initialize_image(input, width, height);
+
+    blur_ctx_t ctx = {input, output, col5, col3, width, height, border, border_value};
+    harness_run(&h, run_blur, NULL, &ctx);
+
+    // Without a border only the interior is defined
+    int margin = border == BLUR_BORDER_NONE ? BLUR_KERNEL_SIZE / 2 : 0;
+
+    // Stored checksums where there are some (clamp, none), otherwise that
+    // of blur_reference; the output must match the reference in any case
+    blur_reference(input, expected, width, height, border, border_value);
+    harness_ref_t mode_references[] = {
+        {h.size, image_checksum(expected, width, height, margin)},
+        {0, 0.0}
+    };
+    const harness_ref_t *stored = border == BLUR_BORDER_CLAMP ? references :
+                                  border == BLUR_BORDER_NONE ? interior_references : NULL;
+    double checksum = image_checksum(output, width, height, margin);
+    if (stored) {
+        harness_check(&h, checksum, stored, 0.0);
+    }
+    if (!stored || !h.has_reference) {
+        harness_check(&h, checksum, mode_references, 0.0);
+    }
+    if (!matches_reference(&ctx, expected, margin)) {
+        h.verified = 0;
+    }
+    harness_dump(&h, HARNESS_U8, (void *const *)(output + margin), height - 2 * margin,
+                 margin, width - 2 * margin);
+
+    printf("Image blur completed in %f seconds\n", harness_best_time(&h));
+    if (width > 200) {
+        printf("Result checksum: output[100][100] = %d, output[200][200] = %d\n",
+               output[100][100], output[200][200]);
+    }
+
+    free(col5);
+    free(col3);
+    free_image(input);
+    free_image(output);
+    free_image(expected);
+
+    return harness_finish(&h);
+}
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
+
+#include "harness.h"
 
 #define WIDTH 512
 #define HEIGHT 512
@@ -60,23 +61,63 @@ void initialize_image(unsigned char **image, int width, int height) {
     }
 }
 
-int main() {
-    unsigned char **input = allocate_image(WIDTH, HEIGHT);
-    unsigned char **output = allocate_image(WIDTH, HEIGHT);
+// Sum of all pixels written by image_blur (the border is left untouched)
+double image_checksum(unsigned char **image, int width, int height) {
+    int offset = KERNEL_SIZE / 2;
+    double sum = 0.0;
+    for (int y = offset; y < height - offset; y++) {
+        for (int x = offset; x < width - offset; x++) {
+            sum += image[y][x];
+        }
+    }
+    return sum;
+}
+
+typedef struct {
+    unsigned char **input, **output;
+    int width, height;
+} blur_ctx_t;
+
+static void run_blur(void *p) {
+    blur_ctx_t *ctx = (blur_ctx_t*)p;
+    image_blur(ctx->input, ctx->output, ctx->width, ctx->height);
+}
+
+// Checksums of square images (size = width = height)
+static const harness_ref_t references[] = {
+    {128, 1952752.0},
+    {256, 8096088.0},
+    {512, 32899448.0},
+    {1024, 132635064.0},
+    {0, 0.0}
+};
+
+int main(int argc, char **argv) {
+    harness_t h;
+    harness_init(&h, "image_blur_unopt", argc, argv, WIDTH);
+    int width = h.size;
+    int height = h.size;
     
-    initialize_image(input, WIDTH, HEIGHT);
+    unsigned char **input = allocate_image(width, height);
+    unsigned char **output = allocate_image(width, height);
     
-    clock_t start = clock();
-    image_blur(input, output, WIDTH, HEIGHT);
-    clock_t end = clock();
+    initialize_image(input, width, height);
     
-    double time_taken = ((double)(end - start)) / CLOCKS_PER_SEC;
-    printf("Image blur completed in %f seconds\n", time_taken);
-    printf("Result checksum: output[100][100] = %d, output[200][200] = %d\n", 
-           output[100][100], output[200][200]);
+    blur_ctx_t ctx = {input, output, width, height};
+    harness_run(&h, run_blur, NULL, &ctx);
+    harness_check(&h, image_checksum(output, width, height), references, 0.0);
+    int offset = KERNEL_SIZE / 2;
+    harness_dump(&h, HARNESS_U8, (void *const *)(output + offset), height - 2 * offset,
+                 offset, width - 2 * offset);
     
-    free_image(input, HEIGHT);
-    free_image(output, HEIGHT);
+    printf("Image blur completed in %f seconds\n", harness_best_time(&h));
+    if (width > 200) {
+        printf("Result checksum: output[100][100] = %d, output[200][200] = %d\n", 
+               output[100][100], output[200][200]);
+    }
+    
+    free_image(input, height);
+    free_image(output, height);
     
-    return 0;
-}
\ No newline at end of file
+    return harness_finish(&h);
+}
@@ -0,0 +1,418 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "blur.h"
+
+// Frame-sequence blur pipeline
+//
+// Blurs a raw video (8-bit grayscale frames of width x height bytes, stored
+// back to back, e.g. "ffmpeg -i in.mp4 -f rawvideo -pix_fmt gray out.raw")
+// with the box-decomposed blur of blur.h. A reader thread loads frame N+1
+// and a writer thread stores frame N-1 while the main thread blurs frame N;
+// each side has two frame buffers, so I/O and compute overlap and the
+// sustained frame rate is that of the slowest stage. --serial runs the same
+// stages one after another for comparison.
+//
+// Native only: gem5 SE runs of the lab model a single hardware thread.
+
+#define DEFAULT_WIDTH 512
+#define DEFAULT_HEIGHT 512
+#define NUM_BUFFERS 2
+
+typedef struct {
+    int in_fd, out_fd;           // out_fd -1: frames are blurred but not stored
+    int width, height;
+    size_t frame_bytes;
+    unsigned char **in[NUM_BUFFERS];
+    unsigned char **out[NUM_BUFFERS];
+    int *col5, *col3;
+    blur_border_t border;
+    unsigned char border_value;  // For BLUR_BORDER_CONSTANT
+
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    int frames_read;             // Frames loaded into in[] so far
+    int frames_blurred;          // Frames blurred into out[] so far
+    int frames_written;          // Frames stored so far
+    int total_frames;            // -1 until the reader reaches the end
+    int error;
+
+    double checksum;             // Sum of all output pixels, to compare modes
+    double blur_seconds;         // Time the main thread spent blurring
+} pipeline_t;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Read a whole frame; returns 1 on success, 0 at end of file, -1 on error
+static int read_frame(int fd, unsigned char *buf, size_t bytes) {
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t n = read(fd, buf + done, bytes - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return -1;
+        }
+        if (n == 0) {
+            // A truncated last frame is dropped
+            if (done > 0) {
+                fprintf(stderr, "Warning: ignoring %zu trailing bytes\n", done);
+            }
+            return 0;
+        }
+        done += (size_t)n;
+    }
+    return 1;
+}
+
+static int write_frame(int fd, const unsigned char *buf, size_t bytes) {
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t n = write(fd, buf + done, bytes - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return -1;
+        }
+        done += (size_t)n;
+    }
+    return 0;
+}
+
+// Blur one frame, border included, so the output is a complete frame
+static void process_frame(pipeline_t *p, unsigned char **in, unsigned char **out) {
+    double start = now_seconds();
+    blur_box(in, out, p->width, p->height, p->col5, p->col3);
+    blur_border(in, out, p->width, p->height, p->border, p->border_value);
+    p->blur_seconds += now_seconds() - start;
+
+    double sum = 0.0;
+    for (size_t i = 0; i < p->frame_bytes; i++) {
+        sum += out[0][i];
+    }
+    p->checksum += sum;
+}
+
+static void fail(pipeline_t *p, const char *what) {
+    pthread_mutex_lock(&p->lock);
+    if (!p->error) {
+        fprintf(stderr, "image_blur_video: %s: %s\n", what, strerror(errno));
+    }
+    p->error = 1;
+    pthread_cond_broadcast(&p->changed);
+    pthread_mutex_unlock(&p->lock);
+}
+
+static void *reader_thread(void *arg) {
+    pipeline_t *p = (pipeline_t*)arg;
+    for (int frame = 0;; frame++) {
+        // Wait until frame - NUM_BUFFERS has been blurred and its buffer is free
+        pthread_mutex_lock(&p->lock);
+        while (!p->error && frame - p->frames_blurred >= NUM_BUFFERS) {
+            pthread_cond_wait(&p->changed, &p->lock);
+        }
+        int stop = p->error;
+        pthread_mutex_unlock(&p->lock);
+        if (stop) {
+            return NULL;
+        }
+
+        int status = read_frame(p->in_fd, p->in[frame % NUM_BUFFERS][0], p->frame_bytes);
+        if (status < 0) {
+            fail(p, "read failed");
+            return NULL;
+        }
+
+        pthread_mutex_lock(&p->lock);
+        if (status == 0) {
+            p->total_frames = frame;
+        } else {
+            p->frames_read = frame + 1;
+        }
+        pthread_cond_broadcast(&p->changed);
+        pthread_mutex_unlock(&p->lock);
+        if (status == 0) {
+            return NULL;
+        }
+    }
+}
+
+static void *writer_thread(void *arg) {
+    pipeline_t *p = (pipeline_t*)arg;
+    for (int frame = 0;; frame++) {
+        pthread_mutex_lock(&p->lock);
+        while (!p->error && p->frames_blurred <= frame &&
+               (p->total_frames < 0 || frame < p->total_frames)) {
+            pthread_cond_wait(&p->changed, &p->lock);
+        }
+        int stop = p->error || p->frames_blurred <= frame;
+        pthread_mutex_unlock(&p->lock);
+        if (stop) {
+            return NULL;
+        }
+
+        if (write_frame(p->out_fd, p->out[frame % NUM_BUFFERS][0], p->frame_bytes) < 0) {
+            fail(p, "write failed");
+            return NULL;
+        }
+
+        pthread_mutex_lock(&p->lock);
+        p->frames_written = frame + 1;
+        pthread_cond_broadcast(&p->changed);
+        pthread_mutex_unlock(&p->lock);
+    }
+}
+
+// Blur stage on the calling thread; returns the number of frames processed
+static int run_pipelined(pipeline_t *p) {
+    pthread_t reader, writer;
+    int writing = p->out_fd >= 0;
+
+    pthread_create(&reader, NULL, reader_thread, p);
+    if (writing) {
+        pthread_create(&writer, NULL, writer_thread, p);
+    }
+
+    int frame = 0;
+    for (;; frame++) {
+        // Wait for the input frame and, when writing, for a free output buffer
+        pthread_mutex_lock(&p->lock);
+        while (!p->error && p->frames_read <= frame &&
+               (p->total_frames < 0 || frame < p->total_frames)) {
+            pthread_cond_wait(&p->changed, &p->lock);
+        }
+        while (writing && !p->error && frame - p->frames_written >= NUM_BUFFERS) {
+            pthread_cond_wait(&p->changed, &p->lock);
+        }
+        int stop = p->error || p->frames_read <= frame;
+        pthread_mutex_unlock(&p->lock);
+        if (stop) {
+            break;
+        }
+
+        process_frame(p, p->in[frame % NUM_BUFFERS], p->out[frame % NUM_BUFFERS]);
+
+        pthread_mutex_lock(&p->lock);
+        p->frames_blurred = frame + 1;
+        pthread_cond_broadcast(&p->changed);
+        pthread_mutex_unlock(&p->lock);
+    }
+
+    pthread_join(reader, NULL);
+    if (writing) {
+        pthread_join(writer, NULL);
+    }
+    return frame;
+}
+
+static int run_serial(pipeline_t *p) {
+    int frame = 0;
+    for (;; frame++) {
+        int status = read_frame(p->in_fd, p->in[0][0], p->frame_bytes);
+        if (status < 0) {
+            fail(p, "read failed");
+        }
+        if (status <= 0) {
+            break;
+        }
+        process_frame(p, p->in[0], p->out[0]);
+        if (p->out_fd >= 0 && write_frame(p->out_fd, p->out[0][0], p->frame_bytes) < 0) {
+            fail(p, "write failed");
+            break;
+        }
+    }
+    return frame;
+}
+
+// Synthetic input: a diagonal gradient that moves by 3 pixels per frame
+static int generate(const char *path, int width, int height, int frames) {
+    unsigned char **frame = allocate_image(width, height);
+    if (!frame) {
+        fprintf(stderr, "image_blur_video: memory allocation failed\n");
+        return 1;
+    }
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "image_blur_video: cannot create %s\n", path);
+        free_image(frame);
+        return 1;
+    }
+    int status = 0;
+    for (int f = 0; f < frames && status == 0; f++) {
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                frame[y][x] = (x + y + 3 * f) % 256;
+            }
+        }
+        if (write_frame(fd, frame[0], (size_t)width * height) < 0) {
+            fprintf(stderr, "image_blur_video: write to %s failed\n", path);
+            status = 1;
+        }
+    }
+    if (close(fd) < 0 && status == 0) {
+        fprintf(stderr, "image_blur_video: close of %s failed\n", path);
+        status = 1;
+    }
+    free_image(frame);
+    if (status == 0) {
+        printf("Wrote %d frames of %dx%d to %s\n", frames, width, height, path);
+    }
+    return status;
+}
+
+static void usage(const char *prog) {
+    printf("Usage: %s --input <file> [options]\n", prog);
+    printf("  --input <file>       Raw 8-bit grayscale frames, back to back\n");
+    printf("  --output <file>      Write the blurred frames (default: blur only)\n");
+    printf("  --width <n>          Frame width (default: %d)\n", DEFAULT_WIDTH);
+    printf("  --height <n>         Frame height (default: %d)\n", DEFAULT_HEIGHT);
+    printf("  --border <mode>      clamp, mirror, wrap or constant[:<0-255>] (default: clamp)\n");
+    printf("  --serial             Read, blur and write one frame at a time\n");
+    printf("  --generate <n>       Write n synthetic frames to --input and exit\n");
+}
+
+static int parse_count(const char *prog, const char *option, const char *value) {
+    char *end;
+    long n = value ? strtol(value, &end, 10) : 0;
+    if (!value || *end != '\0' || n < 1) {
+        fprintf(stderr, "%s: %s expects an integer >= 1\n", prog, option);
+        exit(2);
+    }
+    return (int)n;
+}
+
+int main(int argc, char **argv) {
+    const char *input_path = NULL;
+    const char *output_path = NULL;
+    int width = DEFAULT_WIDTH;
+    int height = DEFAULT_HEIGHT;
+    int serial = 0;
+    int generate_frames = 0;
+    blur_border_t border = BLUR_BORDER_CLAMP;
+    unsigned char border_value = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--input") == 0 && value) {
+            input_path = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && value) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "--width") == 0) {
+            width = parse_count(argv[0], argv[i], value);
+            i++;
+        } else if (strcmp(argv[i], "--height") == 0) {
+            height = parse_count(argv[0], argv[i], value);
+            i++;
+        } else if (strcmp(argv[i], "--generate") == 0) {
+            generate_frames = parse_count(argv[0], argv[i], value);
+            i++;
+        } else if (strcmp(argv[i], "--border") == 0 && value) {
+            if (!blur_parse_border(value, &border, &border_value)) {
+                fprintf(stderr, "%s: unknown border mode '%s'\n", argv[0], value);
+                return 2;
+            }
+            i++;
+        } else if (strcmp(argv[i], "--serial") == 0) {
+            serial = 1;
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            usage(argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr, "%s: invalid option '%s'\n", argv[0], argv[i]);
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!input_path) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (generate_frames) {
+        return generate(input_path, width, height, generate_frames);
+    }
+
+    pipeline_t p;
+    memset(&p, 0, sizeof(p));
+    p.width = width;
+    p.height = height;
+    p.frame_bytes = (size_t)width * height;
+    p.total_frames = -1;
+    p.out_fd = -1;
+    p.border = border;
+    p.border_value = border_value;
+    pthread_mutex_init(&p.lock, NULL);
+    pthread_cond_init(&p.changed, NULL);
+
+    p.in_fd = open(input_path, O_RDONLY);
+    if (p.in_fd < 0) {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0], input_path);
+        return 1;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(p.in_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    if (output_path) {
+        p.out_fd = open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (p.out_fd < 0) {
+            fprintf(stderr, "%s: cannot create %s\n", argv[0], output_path);
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < NUM_BUFFERS; i++) {
+        p.in[i] = allocate_image(width, height);
+        p.out[i] = allocate_image(width, height);
+        if (!p.in[i] || !p.out[i]) {
+            fprintf(stderr, "%s: memory allocation failed\n", argv[0]);
+            return 1;
+        }
+    }
+    p.col5 = (int*)malloc(width * sizeof(int));
+    p.col3 = (int*)malloc(width * sizeof(int));
+    if (!p.col5 || !p.col3) {
+        fprintf(stderr, "%s: memory allocation failed\n", argv[0]);
+        return 1;
+    }
+
+    double start = now_seconds();
+    int frames = serial ? run_serial(&p) : run_pipelined(&p);
+    if (p.out_fd >= 0 && close(p.out_fd) < 0) {
+        fail(&p, "close failed");
+    }
+    double seconds = now_seconds() - start;
+    close(p.in_fd);
+
+    double megabytes = (double)frames * p.frame_bytes / 1e6;
+    printf("image_blur_video: %d frames of %dx%d, %s, %f s\n", frames, width, height,
+           serial ? "serial" : "pipelined", seconds);
+    if (frames > 0 && seconds > 0) {
+        printf("Sustained: %.1f frames/s, %.1f MB/s in%s\n", frames / seconds, megabytes / seconds,
+               output_path ? " and out" : "");
+        printf("Blur stage: %.1f frames/s while busy, busy %.0f%% of the time\n",
+               frames / p.blur_seconds, p.blur_seconds / seconds * 100);
+    }
+    printf("Full checksum: %.10g\n", p.checksum);
+
+    for (int i = 0; i < NUM_BUFFERS; i++) {
+        free_image(p.in[i]);
+        free_image(p.out[i]);
+    }
+    free(p.col5);
+    free(p.col3);
+    pthread_mutex_destroy(&p.lock);
+    pthread_cond_destroy(&p.changed);
+
+    return p.error ? 1 : 0;
+}
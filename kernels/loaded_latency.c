@@ -0,0 +1,371 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// Loaded-latency benchmark
+//
+// Memory latency under background traffic. --threads traffic threads copy
+// their own buffer STREAM-style, 4kB at a time, and spin for a delay
+// between chunks; the delay sets their injection rate. Meanwhile the main
+// thread measures latency with a pointer chase over a random cyclic
+// permutation of cache lines, so that every load misses and depends on the
+// previous one. Each delay is one point of the latency-versus-bandwidth
+// curve; the first point ("idle") runs without traffic.
+//
+// Not built on the harness: it needs threads and its own options. Building
+// with -DGEM5_ROI (make -C kernels latency GEM5_ROI=1) resets gem5's stats
+// before every point and dumps them after it, so stats.txt has one block
+// per point (scripts/latency_curve.py joins them with the printed curve).
+
+#ifdef GEM5_ROI
+#include <gem5/m5ops.h>
+#define ROI_BEGIN() m5_reset_stats(0, 0)
+#define ROI_END() m5_dump_stats(0, 0)
+#else
+#define ROI_BEGIN() ((void)0)
+#define ROI_END() ((void)0)
+#endif
+
+#define LINE_SIZE 64
+#define CHUNK_DOUBLES 512                // 4kB copied between delays
+#define MAX_POINTS 32
+
+#define DEFAULT_THREADS 2
+#define DEFAULT_BUFFER_MB 64
+#define DEFAULT_CHASE_MB 64
+#define DEFAULT_LOADS 1000000
+#define DEFAULT_DELAYS "3000,1000,300,100,30,10,0"
+
+// Idle point: the traffic threads wait
+#define DELAY_IDLE (-1)
+
+typedef struct line {
+    struct line *next;
+    char pad[LINE_SIZE - sizeof(struct line *)];
+} line_t;
+
+// One per traffic thread, a line each to avoid false sharing
+typedef struct {
+    _Alignas(LINE_SIZE) atomic_llong bytes;
+    double *src, *dst;
+    size_t doubles;
+    pthread_t thread;
+} generator_t;
+
+// The main thread publishes delay, then increments point; each traffic
+// thread counts itself in adopted once it runs at the new delay. Between
+// measured points the threads are switched to DELAY_IDLE the same way.
+typedef struct {
+    atomic_int point;                    // Incremented to start a point
+    atomic_int adopted;                  // Threads running the current point
+    atomic_int quit;
+    atomic_int delay;                    // Spin iterations between chunks
+} control_t;
+
+static control_t control;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void spin(int iterations) {
+    for (volatile int i = 0; i < iterations; i++) {
+    }
+}
+
+static void *traffic_thread(void *p) {
+    generator_t *gen = (generator_t*)p;
+    int seen = 0;
+    size_t offset = 0;
+
+    for (;;) {
+        // Wait for the next point
+        while (atomic_load(&control.point) == seen && !atomic_load(&control.quit)) {
+            spin(100);
+        }
+        if (atomic_load(&control.quit)) {
+            return NULL;
+        }
+        seen = atomic_load(&control.point);
+        int delay = atomic_load(&control.delay);
+        atomic_fetch_add(&control.adopted, 1);
+        if (delay == DELAY_IDLE) {
+            continue;
+        }
+
+        while (atomic_load_explicit(&control.point, memory_order_relaxed) == seen) {
+            double *restrict dst = gen->dst + offset;
+            const double *restrict src = gen->src + offset;
+            for (int i = 0; i < CHUNK_DOUBLES; i++) {
+                dst[i] = src[i];
+            }
+            offset = offset + 2 * CHUNK_DOUBLES <= gen->doubles ? offset + CHUNK_DOUBLES : 0;
+            // Bytes read plus bytes written, as STREAM counts Copy
+            atomic_fetch_add_explicit(&gen->bytes, 2 * CHUNK_DOUBLES * sizeof(double),
+                                      memory_order_relaxed);
+            spin(delay);
+        }
+    }
+}
+
+// Start a point and wait until every traffic thread runs at its delay, so
+// no thread misses it or still generates the previous point's traffic
+static void switch_point(int delay, int threads) {
+    atomic_store(&control.adopted, 0);
+    atomic_store(&control.delay, delay);
+    atomic_fetch_add(&control.point, 1);
+    while (atomic_load(&control.adopted) < threads) {
+        spin(100);
+    }
+}
+
+// Random cyclic permutation of the lines (Sattolo's algorithm)
+static line_t *build_chase(size_t nlines, unsigned seed) {
+    line_t *lines = (line_t*)aligned_alloc(LINE_SIZE, nlines * sizeof(line_t));
+    size_t *order = (size_t*)malloc(nlines * sizeof(size_t));
+    if (!lines || !order) {
+        return NULL;
+    }
+    srand(seed);
+    for (size_t i = 0; i < nlines; i++) {
+        order[i] = i;
+    }
+    for (size_t i = nlines - 1; i > 0; i--) {
+        size_t j = ((size_t)rand() * RAND_MAX + rand()) % i;
+        size_t t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+    for (size_t i = 0; i < nlines; i++) {
+        lines[order[i]].next = &lines[order[(i + 1) % nlines]];
+    }
+    free(order);
+    return lines;
+}
+
+static line_t *chase(line_t *p, long loads) {
+    for (long i = 0; i < loads; i++) {
+        p = p->next;
+    }
+    return p;
+}
+
+static long long traffic_bytes(generator_t *gens, int threads) {
+    long long total = 0;
+    for (int t = 0; t < threads; t++) {
+        total += atomic_load(&gens[t].bytes);
+    }
+    return total;
+}
+
+static void usage(const char *prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("  --threads <n>        Traffic threads (default: %d)\n", DEFAULT_THREADS);
+    printf("  --delays <list>      Spin iterations between 4kB chunks, one point each\n");
+    printf("                       (default: %s; 0 is full speed)\n", DEFAULT_DELAYS);
+    printf("  --buffer-mb <n>      Buffer per traffic thread in MB (default: %d)\n", DEFAULT_BUFFER_MB);
+    printf("  --chase-mb <n>       Pointer-chase footprint in MB (default: %d)\n", DEFAULT_CHASE_MB);
+    printf("  --loads <n>          Dependent loads per measurement (default: %d)\n", DEFAULT_LOADS);
+    printf("  --warmup <n>         Untimed measurements before each point (default: 1)\n");
+    printf("  --repeat <n>         Timed measurements per point (default: 1)\n");
+    printf("  --seed <n>           Seed of the chase permutation (default: 42)\n");
+    printf("  --csv <file>         Write the curve as CSV\n");
+}
+
+static long parse_count(const char *prog, const char *option, const char *value, long min) {
+    char *end;
+    long n = value ? strtol(value, &end, 10) : 0;
+    if (!value || *end != '\0' || n < min) {
+        fprintf(stderr, "%s: %s expects an integer >= %ld\n", prog, option, min);
+        exit(2);
+    }
+    return n;
+}
+
+// Comma-separated delays; returns the number parsed
+static int parse_delays(const char *prog, const char *value, int *delays) {
+    char *copy = strdup(value);
+    int count = 0;
+    for (char *token = strtok(copy, ","); token; token = strtok(NULL, ",")) {
+        if (count == MAX_POINTS - 1) {
+            fprintf(stderr, "%s: at most %d delays\n", prog, MAX_POINTS - 1);
+            exit(2);
+        }
+        delays[count++] = (int)parse_count(prog, "--delays", token, 0);
+    }
+    free(copy);
+    return count;
+}
+
+int main(int argc, char **argv) {
+    int threads = DEFAULT_THREADS;
+    long buffer_mb = DEFAULT_BUFFER_MB;
+    long chase_mb = DEFAULT_CHASE_MB;
+    long loads = DEFAULT_LOADS;
+    int warmup = 1;
+    int repeats = 1;
+    unsigned seed = 42;
+    const char *csv_path = NULL;
+    int delays[MAX_POINTS];
+    int ndelays = parse_delays(argv[0], DEFAULT_DELAYS, delays);
+
+    for (int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--threads") == 0) {
+            threads = (int)parse_count(argv[0], argv[i], value, 0);
+            i++;
+        } else if (strcmp(argv[i], "--delays") == 0 && value) {
+            ndelays = parse_delays(argv[0], value, delays);
+            i++;
+        } else if (strcmp(argv[i], "--buffer-mb") == 0) {
+            buffer_mb = parse_count(argv[0], argv[i], value, 1);
+            i++;
+        } else if (strcmp(argv[i], "--chase-mb") == 0) {
+            chase_mb = parse_count(argv[0], argv[i], value, 1);
+            i++;
+        } else if (strcmp(argv[i], "--loads") == 0) {
+            loads = parse_count(argv[0], argv[i], value, 1);
+            i++;
+        } else if (strcmp(argv[i], "--warmup") == 0) {
+            warmup = (int)parse_count(argv[0], argv[i], value, 0);
+            i++;
+        } else if (strcmp(argv[i], "--repeat") == 0) {
+            repeats = (int)parse_count(argv[0], argv[i], value, 1);
+            i++;
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            seed = (unsigned)parse_count(argv[0], argv[i], value, 0);
+            i++;
+        } else if (strcmp(argv[i], "--csv") == 0 && value) {
+            csv_path = argv[++i];
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            usage(argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr, "%s: invalid option '%s'\n", argv[0], argv[i]);
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus > 0 && threads + 1 > cpus) {
+        fprintf(stderr, "Warning: %d traffic threads and the chase share %ld CPUs; "
+                "latencies include scheduling\n", threads, cpus);
+    }
+
+    size_t nlines = (size_t)chase_mb * 1024 * 1024 / LINE_SIZE;
+    line_t *lines = build_chase(nlines, seed);
+    generator_t *gens = (generator_t*)aligned_alloc(LINE_SIZE, (threads + 1) * sizeof(generator_t));
+    if (!lines || !gens) {
+        fprintf(stderr, "%s: memory allocation failed\n", argv[0]);
+        return 1;
+    }
+
+    // Half of each buffer is the source, half the destination
+    size_t buffer_doubles = (size_t)buffer_mb * 1024 * 1024 / sizeof(double) / 2;
+    if (buffer_doubles < 2 * CHUNK_DOUBLES) {
+        buffer_doubles = 2 * CHUNK_DOUBLES;
+    }
+    for (int t = 0; t < threads; t++) {
+        generator_t *gen = &gens[t];
+        atomic_init(&gen->bytes, 0);
+        gen->doubles = buffer_doubles;
+        gen->src = (double*)malloc(buffer_doubles * sizeof(double));
+        gen->dst = (double*)malloc(buffer_doubles * sizeof(double));
+        if (!gen->src || !gen->dst) {
+            fprintf(stderr, "%s: memory allocation failed\n", argv[0]);
+            return 1;
+        }
+        for (size_t i = 0; i < buffer_doubles; i++) {
+            gen->src[i] = (double)i;
+            gen->dst[i] = 0.0;
+        }
+    }
+
+    atomic_init(&control.point, 0);
+    atomic_init(&control.adopted, 0);
+    atomic_init(&control.quit, 0);
+    atomic_init(&control.delay, DELAY_IDLE);
+    for (int t = 0; t < threads; t++) {
+        if (pthread_create(&gens[t].thread, NULL, traffic_thread, &gens[t]) != 0) {
+            fprintf(stderr, "%s: cannot create traffic thread %d\n", argv[0], t);
+            return 1;
+        }
+    }
+
+    // Point 0 is idle, the rest follow --delays
+    int points[MAX_POINTS];
+    int npoints = 0;
+    points[npoints++] = DELAY_IDLE;
+    for (int d = 0; d < ndelays; d++) {
+        points[npoints++] = delays[d];
+    }
+    double bandwidth[MAX_POINTS];
+    double latency[MAX_POINTS];
+
+    printf("Loaded latency: %d traffic threads x %ld MB, chase over %ld MB, %ld loads x %d per point\n",
+           threads, buffer_mb, chase_mb, loads, repeats);
+    printf("%-10s %14s %14s\n", "Delay", "Traffic GB/s", "Latency (ns)");
+
+    line_t *p = &lines[0];
+    for (int pt = 0; pt < npoints; pt++) {
+        switch_point(points[pt], threads);
+
+        for (int w = 0; w < warmup; w++) {
+            p = chase(p, loads);
+        }
+
+        ROI_BEGIN();
+        long long bytes_start = traffic_bytes(gens, threads);
+        double start = now_seconds();
+        p = chase(p, loads * repeats);
+        double seconds = now_seconds() - start;
+        long long bytes = traffic_bytes(gens, threads) - bytes_start;
+        ROI_END();
+
+        switch_point(DELAY_IDLE, threads);
+
+        bandwidth[pt] = bytes / seconds / 1e9;
+        latency[pt] = seconds / (loads * repeats) * 1e9;
+        if (points[pt] == DELAY_IDLE) {
+            printf("%-10s %14.2f %14.1f\n", "idle", bandwidth[pt], latency[pt]);
+        } else {
+            printf("%-10d %14.2f %14.1f\n", points[pt], bandwidth[pt], latency[pt]);
+        }
+        fflush(stdout);
+    }
+
+    atomic_store(&control.quit, 1);
+    for (int t = 0; t < threads; t++) {
+        pthread_join(gens[t].thread, NULL);
+    }
+    // Keeps the chase from being optimized away
+    printf("Chase ended at line %ld\n", (long)(p - lines));
+
+    if (csv_path) {
+        FILE *f = fopen(csv_path, "w");
+        if (!f) {
+            fprintf(stderr, "%s: cannot write %s\n", argv[0], csv_path);
+            return 1;
+        }
+        fprintf(f, "delay,traffic_gbps,latency_ns\n");
+        for (int pt = 0; pt < npoints; pt++) {
+            fprintf(f, "%d,%.4f,%.3f\n", points[pt], bandwidth[pt], latency[pt]);
+        }
+        fclose(f);
+    }
+
+    for (int t = 0; t < threads; t++) {
+        free(gens[t].src);
+        free(gens[t].dst);
+    }
+    free(gens);
+    free(lines);
+    return 0;
+}
@@ -0,0 +1,249 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "harness.h"
+#include "gemm.h"
+
+// LU factorization with partial pivoting, PA = LU
+//
+// kernels/Makefile generates one kernel per form from this file
+// (lu_factor_unopt, lu_factor_blocked, lu_factor_recursive, see
+// FACTOR_FORMS there) by defining FORM_UNOPT, FORM_BLOCKED or
+// FORM_RECURSIVE and KERNEL_NAME:
+//   unopt      right-looking, one column at a time over the whole matrix:
+//              every step streams the full trailing matrix
+//   blocked    right-looking with FACTOR_BLOCK-column panels: an unblocked
+//              panel factorization (latency-bound), a triangular solve for
+//              the block row of U and a gemm_blocked trailing update
+//              (cache-bound) that carries most of the flops
+//   recursive  splits the columns in half down to RECURSIVE_LEAF columns;
+//              the updates are gemm_blocked calls of every size
+//
+// L (unit diagonal, not stored) and U overwrite the matrix. Each element
+// receives the same updates in the same order in every form, so all forms
+// produce bit-identical factors and pivots.
+
+#if !defined(FORM_UNOPT) && !defined(FORM_BLOCKED) && !defined(FORM_RECURSIVE)
+#define FORM_UNOPT
+#endif
+#ifndef KERNEL_NAME
+#define KERNEL_NAME "lu_factor"
+#endif
+
+#define SIZE 256
+
+// Panel width of the blocked form
+#ifndef FACTOR_BLOCK
+#define FACTOR_BLOCK 32
+#endif
+
+// Widest panel the recursive form factors column by column
+#define RECURSIVE_LEAF 8
+
+static void swap_rows(block_t a, int r1, int r2, int ncols) {
+    double *x = block_row(a, r1);
+    double *y = block_row(a, r2);
+    for (int j = 0; j < ncols; j++) {
+        double t = x[j];
+        x[j] = y[j];
+        y[j] = t;
+    }
+}
+
+// Row interchanges piv[k0..k1) (row k with row piv[k]) on ncols columns
+static void apply_pivots(block_t a, const int *piv, int k0, int k1, int ncols) {
+    for (int k = k0; k < k1; k++) {
+        if (piv[k] != k) {
+            swap_rows(a, k, piv[k], ncols);
+        }
+    }
+}
+
+// Unblocked right-looking LU of an m x n panel (m >= n); piv relative to
+// the panel's first row
+static void lu_unblocked(block_t a, int m, int n, int *piv) {
+    for (int k = 0; k < n; k++) {
+        int p = k;
+        double max = fabs(block_row(a, k)[k]);
+        for (int i = k + 1; i < m; i++) {
+            if (fabs(block_row(a, i)[k]) > max) {
+                max = fabs(block_row(a, i)[k]);
+                p = i;
+            }
+        }
+        piv[k] = p;
+        if (p != k) {
+            swap_rows(a, k, p, n);
+        }
+
+        double pivot = block_row(a, k)[k];
+        if (pivot == 0.0) {
+            continue;            // Singular: leave the column as it is
+        }
+        const double *row_k = block_row(a, k);
+        for (int i = k + 1; i < m; i++) {
+            double *row_i = block_row(a, i);
+            row_i[k] /= pivot;
+            double l_ik = row_i[k];
+            for (int j = k + 1; j < n; j++) {
+                row_i[j] -= l_ik * row_k[j];
+            }
+        }
+    }
+}
+
+// B (m x n) = L^-1 B, L unit lower triangular m x m
+static void trsm_lower_unit(block_t l, block_t b, int m, int n) {
+    for (int i = 0; i < m; i++) {
+        double *row_i = block_row(b, i);
+        for (int k = 0; k < i; k++) {
+            double l_ik = block_row(l, i)[k];
+            const double *row_k = block_row(b, k);
+            for (int j = 0; j < n; j++) {
+                row_i[j] -= l_ik * row_k[j];
+            }
+        }
+    }
+}
+
+void lu_blocked(block_t a, int n, int *piv) {
+    for (int k0 = 0; k0 < n; k0 += FACTOR_BLOCK) {
+        int kb = k0 + FACTOR_BLOCK < n ? FACTOR_BLOCK : n - k0;
+        int rest = n - k0 - kb;
+
+        lu_unblocked(block_at(a, k0, k0), n - k0, kb, piv + k0);
+        for (int k = k0; k < k0 + kb; k++) {
+            piv[k] += k0;
+        }
+        apply_pivots(a, piv, k0, k0 + kb, k0);
+        apply_pivots(block_at(a, 0, k0 + kb), piv, k0, k0 + kb, rest);
+
+        trsm_lower_unit(block_at(a, k0, k0), block_at(a, k0, k0 + kb), kb, rest);
+        gemm_blocked(block_at(a, k0 + kb, k0), block_at(a, k0, k0 + kb),
+                     block_at(a, k0 + kb, k0 + kb), n - k0 - kb, rest, kb, -1.0);
+    }
+}
+
+// m x n panel, m >= n; piv relative to the panel's first row
+void lu_recursive(block_t a, int m, int n, int *piv) {
+    if (n <= RECURSIVE_LEAF) {
+        lu_unblocked(a, m, n, piv);
+        return;
+    }
+    int n1 = n / 2;
+    int n2 = n - n1;
+
+    lu_recursive(a, m, n1, piv);
+    apply_pivots(block_at(a, 0, n1), piv, 0, n1, n2);
+    trsm_lower_unit(a, block_at(a, 0, n1), n1, n2);
+    gemm_blocked(block_at(a, n1, 0), block_at(a, 0, n1), block_at(a, n1, n1),
+                 m - n1, n2, n1, -1.0);
+
+    lu_recursive(block_at(a, n1, n1), m - n1, n2, piv + n1);
+    for (int k = n1; k < n; k++) {
+        piv[k] += n1;
+    }
+    apply_pivots(a, piv, n1, n, n1);
+}
+
+void lu_factor(block_t a, int n, int *piv) {
+#if defined(FORM_BLOCKED)
+    lu_blocked(a, n, piv);
+#elif defined(FORM_RECURSIVE)
+    lu_recursive(a, n, n, piv);
+#else
+    lu_unblocked(a, n, n, piv);
+#endif
+}
+
+// Same value distribution as matrix_mult_unopt
+void initialize_matrix(block_t a, int n) {
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            block_row(a, i)[j] = (double)(rand() % 100) / 10.0;
+        }
+    }
+}
+
+double factor_checksum(block_t a, const int *piv, int n) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            sum += block_row(a, i)[j];
+        }
+        sum += piv[i];
+    }
+    return sum;
+}
+
+typedef struct {
+    block_t a;
+    const double *input;
+    int *piv;
+    int n;
+} lu_ctx_t;
+
+static void run_factor(void *p) {
+    lu_ctx_t *ctx = (lu_ctx_t*)p;
+    lu_factor(ctx->a, ctx->n, ctx->piv);
+}
+
+// The factorization works in place: restore the input before every run
+static void reset_matrix(void *p) {
+    lu_ctx_t *ctx = (lu_ctx_t*)p;
+    memcpy(ctx->a.data, ctx->input, (size_t)ctx->n * ctx->n * sizeof(double));
+}
+
+// Sum of L, U and the pivot indices for the default seed
+static const harness_ref_t references[] = {
+    {64, 3865.7779279248653},
+    {128, 14092.938457078842},
+    {256, 57407.937940262105},
+    {512, 222222.50972727835},
+    {0, 0.0}
+};
+
+int main(int argc, char **argv) {
+    harness_t h;
+    harness_init(&h, KERNEL_NAME, argc, argv, SIZE);
+    int n = h.size;
+
+    srand(h.seed);  // Fixed seed for reproducible results
+
+    size_t elements = (size_t)n * n;
+    double *input = (double*)malloc(elements * sizeof(double));
+    double *data = (double*)malloc(elements * sizeof(double));
+    int *piv = (int*)malloc(n * sizeof(int));
+    double **rows = (double**)malloc(n * sizeof(double*));
+    if (!input || !data || !piv || !rows) {
+        fprintf(stderr, "%s: memory allocation failed\n", KERNEL_NAME);
+        return 1;
+    }
+    block_t input_block = {input, n};
+    initialize_matrix(input_block, n);
+
+    lu_ctx_t ctx = {{data, n}, input, piv, n};
+    harness_run(&h, run_factor, reset_matrix, &ctx);
+    harness_check(&h, factor_checksum(ctx.a, piv, n), references, 1e-9);
+
+    double *pivots = (double*)malloc(n * sizeof(double));
+    for (int i = 0; i < n; i++) {
+        rows[i] = block_row(ctx.a, i);
+        pivots[i] = piv[i];
+    }
+    harness_dump(&h, HARNESS_F64, (void *const *)rows, n, 0, n);
+    harness_dump(&h, HARNESS_F64, (void *const *)&pivots, 1, 0, n);
+
+    printf("LU factorization completed in %f seconds\n", harness_best_time(&h));
+    printf("U[0][0] = %f, U[n-1][n-1] = %f\n", data[0], data[elements - 1]);
+
+    free(input);
+    free(data);
+    free(piv);
+    free(rows);
+    free(pivots);
+
+    return harness_finish(&h);
+}
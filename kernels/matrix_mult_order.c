@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "harness.h"
+
+// Loop-order template for matrix multiplication
+//
+// kernels/Makefile generates one kernel per loop order and tile size from
+// this file (matrix_mult_<order> and matrix_mult_<order>_t<tile>, see
+// MM_ORDERS and MM_TILES there) by defining:
+//   ORDER        loop variables outermost first, e.g. "i, k, j"
+//   TILE         tile size, 0 for an untiled nest
+//   KERNEL_NAME  name reported by the harness
+//
+// Tiled nests run the tile loops in the same order as the element loops.
+// In every order each C[i][j] accumulates its products in increasing k, so
+// all variants produce bit-identical results to matrix_mult_unopt.
+
+#ifndef ORDER
+#define ORDER i, k, j
+#endif
+#ifndef TILE
+#define TILE 0
+#endif
+#ifndef KERNEL_NAME
+#define KERNEL_NAME "matrix_mult_order"
+#endif
+
+#define SIZE 256
+
+// v##v is the tile loop of v (ii, jj, kk); v##_end its element loop bound
+#define TILE_LOOP(v) for (int v##v = 0; v##v < n; v##v += tile)
+#define ELEMENT_LOOP(v) for (int v = v##v, v##_end = v##v + tile < n ? v##v + tile : n; v < v##_end; v++)
+#define NEST(a, b, c) \
+    TILE_LOOP(a) TILE_LOOP(b) TILE_LOOP(c) \
+    ELEMENT_LOOP(a) ELEMENT_LOOP(b) ELEMENT_LOOP(c) \
+        C[i][j] += A[i][k] * B[k][j];
+#define EXPAND_NEST(...) NEST(__VA_ARGS__)
+
+void matrix_multiply(double **A, double **B, double **C, int n) {
+    // Untiled: one tile covering the whole matrix
+    int tile = TILE > 0 ? TILE : n;
+    EXPAND_NEST(ORDER)
+}
+
+double** allocate_matrix(int n) {
+    double **matrix = (double**)malloc(n * sizeof(double*));
+    for (int i = 0; i < n; i++) {
+        matrix[i] = (double*)malloc(n * sizeof(double));
+    }
+    return matrix;
+}
+
+void free_matrix(double **matrix, int n) {
+    for (int i = 0; i < n; i++) {
+        free(matrix[i]);
+    }
+    free(matrix);
+}
+
+void initialize_matrix(double **matrix, int n) {
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            matrix[i][j] = (double)(rand() % 100) / 10.0;
+        }
+    }
+}
+
+void zero_matrix(double **matrix, int n) {
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            matrix[i][j] = 0.0;
+        }
+    }
+}
+
+double matrix_checksum(double **matrix, int n) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            sum += matrix[i][j];
+        }
+    }
+    return sum;
+}
+
+typedef struct {
+    double **A, **B, **C;
+    int n;
+} matrix_ctx_t;
+
+static void run_multiply(void *p) {
+    matrix_ctx_t *ctx = (matrix_ctx_t*)p;
+    matrix_multiply(ctx->A, ctx->B, ctx->C, ctx->n);
+}
+
+static void reset_output(void *p) {
+    matrix_ctx_t *ctx = (matrix_ctx_t*)p;
+    zero_matrix(ctx->C, ctx->n);
+}
+
+// Sum of all elements of C for the default seed, as matrix_mult_unopt
+static const harness_ref_t references[] = {
+    {64, 6440146.8699999973},
+    {128, 51231352.890000097},
+    {256, 411458309.32000059},
+    {512, 3280570396.9699998},
+    {0, 0.0}
+};
+
+int main(int argc, char **argv) {
+    harness_t h;
+    harness_init(&h, KERNEL_NAME, argc, argv, SIZE);
+    int n = h.size;
+
+    srand(h.seed);  // Fixed seed for reproducible results
+
+    double **A = allocate_matrix(n);
+    double **B = allocate_matrix(n);
+    double **C = allocate_matrix(n);
+
+    initialize_matrix(A, n);
+    initialize_matrix(B, n);
+
+    matrix_ctx_t ctx = {A, B, C, n};
+    harness_run(&h, run_multiply, reset_output, &ctx);
+    harness_check(&h, matrix_checksum(C, n), references, 1e-9);
+    harness_dump(&h, HARNESS_F64, (void *const *)C, n, 0, n);
+
+    printf("Matrix multiplication completed in %f seconds\n", harness_best_time(&h));
+    if (n > 100) {
+        printf("Result checksum: C[0][0] = %f, C[100][100] = %f\n", C[0][0], C[100][100]);
+    }
+
+    free_matrix(A, n);
+    free_matrix(B, n);
+    free_matrix(C, n);
+
+    return harness_finish(&h);
+}
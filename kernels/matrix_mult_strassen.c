@@ -0,0 +1,252 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "harness.h"
+#include "gemm.h"
+
+#define SIZE 256
+
+// Largest base case: blocks of at most this size are multiplied classically
+#ifndef STRASSEN_CUTOFF
+#define STRASSEN_CUTOFF 64
+#endif
+
+// Strassen-Winograd matrix multiplication
+//
+// Each level splits the operands into quadrants and forms C from 7 half-size
+// products and 15 quadrant additions instead of 8 products (Winograd's
+// variant of Strassen's algorithm). The schedule below (Boyer, Dumas, Pernet
+// and Zhou, "Memory efficient scheduling of Strassen-Winograd's matrix
+// multiplication algorithm") needs only two temporaries per level, X and Y,
+// and keeps the other intermediate sums in the quadrants of C. Temporaries
+// come from one arena allocated before timing: level l takes its X and Y
+// from the front of the arena it is given and passes the rest down, so no
+// allocation happens inside the multiply.
+//
+// n is padded with zeros to base << levels with base <= STRASSEN_CUTOFF;
+// base-sized blocks are multiplied with gemm_blocked (gemm.h). The
+// result is not bit-identical to matrix_mult_unopt: the additions round
+// differently, within scripts/verify_kernels.py's default ulp tolerance.
+
+static inline block_t quadrant(block_t m, int h, int qi, int qj) {
+    return block_at(m, qi * h, qj * h);
+}
+
+// c = a + sign * b on h x h blocks; c may alias a or b
+static void block_add(block_t a, block_t b, block_t c, int h, double sign) {
+    for (int i = 0; i < h; i++) {
+        const double *ra = a.data + (size_t)i * a.ld;
+        const double *rb = b.data + (size_t)i * b.ld;
+        double *rc = c.data + (size_t)i * c.ld;
+        for (int j = 0; j < h; j++) {
+            rc[j] = ra[j] + sign * rb[j];
+        }
+    }
+}
+
+// c = a * b, blocked classical
+static void multiply_base(block_t a, block_t b, block_t c, int n) {
+    for (int i = 0; i < n; i++) {
+        memset(block_row(c, i), 0, n * sizeof(double));
+    }
+    gemm_blocked(a, b, c, n, n, n, 1.0);
+}
+
+// c = a * b on n x n blocks, n = base << levels
+static void multiply_block(block_t a, block_t b, block_t c, int n, int levels, double *arena) {
+    if (levels == 0) {
+        multiply_base(a, b, c, n);
+        return;
+    }
+    int h = n / 2;
+    block_t a11 = quadrant(a, h, 0, 0), a12 = quadrant(a, h, 0, 1);
+    block_t a21 = quadrant(a, h, 1, 0), a22 = quadrant(a, h, 1, 1);
+    block_t b11 = quadrant(b, h, 0, 0), b12 = quadrant(b, h, 0, 1);
+    block_t b21 = quadrant(b, h, 1, 0), b22 = quadrant(b, h, 1, 1);
+    block_t c11 = quadrant(c, h, 0, 0), c12 = quadrant(c, h, 0, 1);
+    block_t c21 = quadrant(c, h, 1, 0), c22 = quadrant(c, h, 1, 1);
+    block_t x = {arena, h};
+    block_t y = {arena + (size_t)h * h, h};
+    double *rest = arena + 2 * (size_t)h * h;
+    int sub = levels - 1;
+
+    block_add(a11, a21, x, h, -1.0);             // S3 = A11 - A21
+    block_add(b22, b12, y, h, -1.0);             // T3 = B22 - B12
+    multiply_block(x, y, c21, h, sub, rest);     // P7 = S3 T3
+    block_add(a21, a22, x, h, 1.0);              // S1 = A21 + A22
+    block_add(b12, b11, y, h, -1.0);             // T1 = B12 - B11
+    multiply_block(x, y, c22, h, sub, rest);     // P5 = S1 T1
+    block_add(x, a11, x, h, -1.0);               // S2 = S1 - A11
+    block_add(b22, y, y, h, -1.0);               // T2 = B22 - T1
+    multiply_block(x, y, c12, h, sub, rest);     // P6 = S2 T2
+    block_add(a12, x, x, h, -1.0);               // S4 = A12 - S2
+    multiply_block(x, b22, c11, h, sub, rest);   // P3 = S4 B22
+    multiply_block(a11, b11, x, h, sub, rest);   // P1 = A11 B11
+    block_add(x, c12, c12, h, 1.0);              // U2 = P1 + P6
+    block_add(c12, c21, c21, h, 1.0);            // U3 = U2 + P7
+    block_add(c12, c22, c12, h, 1.0);            // U4 = U2 + P5
+    block_add(c21, c22, c22, h, 1.0);            // U7 = U3 + P5 = C22
+    block_add(c12, c11, c12, h, 1.0);            // U5 = U4 + P3 = C12
+    block_add(y, b21, y, h, -1.0);               // T4 = T2 - B21
+    multiply_block(a22, y, c11, h, sub, rest);   // P4 = A22 T4
+    block_add(c21, c11, c21, h, -1.0);           // U6 = U3 - P4 = C21
+    multiply_block(a12, b21, c11, h, sub, rest); // P2 = A12 B21
+    block_add(x, c11, c11, h, 1.0);              // U1 = P1 + P2 = C11
+}
+
+// Elements of temporaries needed below an n x n level: X and Y of every
+// level, 2/3 n^2 in total
+static size_t arena_elements(int n, int levels) {
+    size_t total = 0;
+    for (int l = 1; l <= levels; l++) {
+        size_t h = (size_t)(n >> l);
+        total += 2 * h * h;
+    }
+    return total;
+}
+
+// Bytes the quadrant additions read and write per multiply: 15 additions of
+// two h x h inputs into one output per level, times 7 calls per level below
+static double addition_bytes(int n, int levels) {
+    if (levels == 0) {
+        return 0.0;
+    }
+    double h = n / 2;
+    return 15.0 * 3.0 * h * h * sizeof(double) + 7.0 * addition_bytes(n / 2, levels - 1);
+}
+
+double** allocate_matrix(int n) {
+    double **matrix = (double**)malloc(n * sizeof(double*));
+    for (int i = 0; i < n; i++) {
+        matrix[i] = (double*)malloc(n * sizeof(double));
+    }
+    return matrix;
+}
+
+void free_matrix(double **matrix, int n) {
+    for (int i = 0; i < n; i++) {
+        free(matrix[i]);
+    }
+    free(matrix);
+}
+
+void initialize_matrix(double **matrix, int n) {
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            matrix[i][j] = (double)(rand() % 100) / 10.0;
+        }
+    }
+}
+
+double matrix_checksum(double **matrix, int n) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            sum += matrix[i][j];
+        }
+    }
+    return sum;
+}
+
+typedef struct {
+    block_t A, B, C;
+    int n;                       // Padded size
+    int levels;
+    double *arena;
+} matrix_ctx_t;
+
+static void run_multiply(void *p) {
+    matrix_ctx_t *ctx = (matrix_ctx_t*)p;
+    multiply_block(ctx->A, ctx->B, ctx->C, ctx->n, ctx->levels, ctx->arena);
+}
+
+// Sum of all elements of C for the default seed, as matrix_mult_unopt
+static const harness_ref_t references[] = {
+    {64, 6440146.8699999973},
+    {128, 51231352.890000097},
+    {256, 411458309.32000059},
+    {512, 3280570396.9699998},
+    {0, 0.0}
+};
+
+int main(int argc, char **argv) {
+    harness_t h;
+    harness_init(&h, "matrix_mult_strassen", argc, argv, SIZE);
+    int n = h.size;
+
+    // Recurse until the blocks are at most STRASSEN_CUTOFF, then pad n up
+    // to a multiple of the 2^levels blocks per side
+    int levels = 0;
+    while (((n + (1 << levels) - 1) >> levels) > STRASSEN_CUTOFF) {
+        levels++;
+    }
+    int base = (n + (1 << levels) - 1) >> levels;
+    int padded = base << levels;
+
+    srand(h.seed);  // Fixed seed for reproducible results
+
+    // Same inputs as matrix_mult_unopt, generated row-major
+    double **A = allocate_matrix(n);
+    double **B = allocate_matrix(n);
+    double **C = allocate_matrix(n);
+    initialize_matrix(A, n);
+    initialize_matrix(B, n);
+
+    size_t elements = (size_t)padded * padded;
+    size_t arena_size = arena_elements(padded, levels);
+    matrix_ctx_t ctx;
+    ctx.A.data = (double*)calloc(elements, sizeof(double));
+    ctx.B.data = (double*)calloc(elements, sizeof(double));
+    ctx.C.data = (double*)calloc(elements, sizeof(double));
+    ctx.arena = (double*)malloc((arena_size ? arena_size : 1) * sizeof(double));
+    if (!ctx.A.data || !ctx.B.data || !ctx.C.data || !ctx.arena) {
+        fprintf(stderr, "matrix_mult_strassen: memory allocation failed\n");
+        return 1;
+    }
+    ctx.A.ld = ctx.B.ld = ctx.C.ld = padded;
+    ctx.n = padded;
+    ctx.levels = levels;
+    for (int i = 0; i < n; i++) {
+        memcpy(ctx.A.data + (size_t)i * padded, A[i], n * sizeof(double));
+        memcpy(ctx.B.data + (size_t)i * padded, B[i], n * sizeof(double));
+    }
+
+    harness_run(&h, run_multiply, NULL, &ctx);
+    for (int i = 0; i < n; i++) {
+        memcpy(C[i], ctx.C.data + (size_t)i * padded, n * sizeof(double));
+    }
+    harness_check(&h, matrix_checksum(C, n), references, 1e-9);
+    harness_dump(&h, HARNESS_F64, (void *const *)C, n, 0, n);
+
+    // Cost of the temporaries: the arena and the traffic of the additions,
+    // against the 3 n^2 elements of the operands
+    double operand_bytes = 3.0 * elements * sizeof(double);
+    double adds = addition_bytes(padded, levels);
+    double base_products = 1.0;
+    for (int l = 0; l < levels; l++) {
+        base_products *= 7.0;
+    }
+    printf("Strassen-Winograd: depth %d, %dx%d blocks (padded to %d), "
+           "%.0f base products, %.1f%% of the classical multiply-adds\n",
+           levels, base, base, padded, base_products,
+           100.0 * base_products * base * base * base / ((double)padded * padded * padded));
+    printf("Temporaries: arena %.2f MB (%.2fx the operands), additions move %.2f MB "
+           "per multiply (%.2fx the operands)\n",
+           arena_size * sizeof(double) / 1e6, arena_size * sizeof(double) / operand_bytes,
+           adds / 1e6, adds / operand_bytes);
+    printf("Matrix multiplication completed in %f seconds\n", harness_best_time(&h));
+    if (n > 100) {
+        printf("Result checksum: C[0][0] = %f, C[100][100] = %f\n", C[0][0], C[100][100]);
+    }
+
+    free(ctx.A.data);
+    free(ctx.B.data);
+    free(ctx.C.data);
+    free(ctx.arena);
+    free_matrix(A, n);
+    free_matrix(B, n);
+    free_matrix(C, n);
+
+    return harness_finish(&h);
+}
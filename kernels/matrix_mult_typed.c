@@ -0,0 +1,213 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "harness.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Element-type template for matrix multiplication
+//
+// kernels/Makefile generates one kernel per element type and tile size from
+// this file (matrix_mult_<type> and matrix_mult_<type>_t<tile>, see
+// MM_TYPES and MM_TILES there) by defining:
+//   ELEM_F32     float elements, float accumulation
+//   ELEM_I16     int16_t elements, int32_t accumulation
+//   ELEM_I8      int8_t elements, int32_t accumulation
+//   TILE         tile size in elements, 0 for an untiled nest
+//   KERNEL_NAME  name reported by the harness
+//
+// The loop nest is that of matrix_mult_ikj(_t32): with the same tile size
+// in elements, a tile of A or B takes 1/2 (float), 1/4 (int16) or 1/8
+// (int8) of the bytes of a double tile, so more of them fit in L1D. C is
+// 4 bytes per element in all three types.
+//
+// Inputs are integers in [-8, 7] so that every type computes the same exact
+// C (|C| <= 64 n, exact in float up to n = 2^18): the kernels check each
+// other. When compiled with AVX2 (e.g. -march=native), the inner loop
+// processes 8 elements of a row of C at a time, widening int16 and int8 to
+// int32 lanes; otherwise it is left to the compiler.
+
+#if !defined(ELEM_F32) && !defined(ELEM_I16) && !defined(ELEM_I8)
+#define ELEM_F32
+#endif
+#ifndef TILE
+#define TILE 0
+#endif
+#ifndef KERNEL_NAME
+#define KERNEL_NAME "matrix_mult_typed"
+#endif
+
+#if defined(ELEM_F32)
+typedef float elem_t;
+typedef float acc_t;
+#elif defined(ELEM_I16)
+typedef int16_t elem_t;
+typedef int32_t acc_t;
+#else
+typedef int8_t elem_t;
+typedef int32_t acc_t;
+#endif
+
+#define SIZE 256
+
+// c[j] += a * b[j] for j in [j0, j1)
+static inline void row_update(acc_t *restrict c, const elem_t *restrict b, elem_t a,
+                              int j0, int j1) {
+    int j = j0;
+#if defined(__AVX2__) && defined(ELEM_F32)
+    __m256 va = _mm256_set1_ps(a);
+    for (; j + 8 <= j1; j += 8) {
+        __m256 vc = _mm256_loadu_ps(c + j);
+        vc = _mm256_add_ps(vc, _mm256_mul_ps(va, _mm256_loadu_ps(b + j)));
+        _mm256_storeu_ps(c + j, vc);
+    }
+#elif defined(__AVX2__) && defined(ELEM_I16)
+    __m256i va = _mm256_set1_epi32(a);
+    for (; j + 8 <= j1; j += 8) {
+        __m256i vb = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(b + j)));
+        __m256i vc = _mm256_loadu_si256((const __m256i*)(c + j));
+        vc = _mm256_add_epi32(vc, _mm256_mullo_epi32(va, vb));
+        _mm256_storeu_si256((__m256i*)(c + j), vc);
+    }
+#elif defined(__AVX2__) && defined(ELEM_I8)
+    __m256i va = _mm256_set1_epi32(a);
+    for (; j + 8 <= j1; j += 8) {
+        __m256i vb = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)(b + j)));
+        __m256i vc = _mm256_loadu_si256((const __m256i*)(c + j));
+        vc = _mm256_add_epi32(vc, _mm256_mullo_epi32(va, vb));
+        _mm256_storeu_si256((__m256i*)(c + j), vc);
+    }
+#endif
+    for (; j < j1; j++) {
+        c[j] += (acc_t)a * b[j];
+    }
+}
+
+void matrix_multiply(elem_t **A, elem_t **B, acc_t **C, int n) {
+    // Untiled: one tile covering the whole matrix
+    int tile = TILE > 0 ? TILE : n;
+    for (int ii = 0; ii < n; ii += tile) {
+        int i_end = ii + tile < n ? ii + tile : n;
+        for (int kk = 0; kk < n; kk += tile) {
+            int k_end = kk + tile < n ? kk + tile : n;
+            for (int jj = 0; jj < n; jj += tile) {
+                int j_end = jj + tile < n ? jj + tile : n;
+                for (int i = ii; i < i_end; i++) {
+                    for (int k = kk; k < k_end; k++) {
+                        row_update(C[i], B[k], A[i][k], jj, j_end);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void** allocate_matrix(int n, size_t element_size) {
+    void **matrix = (void**)malloc(n * sizeof(void*));
+    for (int i = 0; i < n; i++) {
+        matrix[i] = malloc(n * element_size);
+    }
+    return matrix;
+}
+
+void free_matrix(void **matrix, int n) {
+    for (int i = 0; i < n; i++) {
+        free(matrix[i]);
+    }
+    free(matrix);
+}
+
+void initialize_matrix(elem_t **matrix, int n) {
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            matrix[i][j] = (elem_t)(rand() % 16 - 8);
+        }
+    }
+}
+
+void zero_matrix(acc_t **matrix, int n) {
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            matrix[i][j] = 0;
+        }
+    }
+}
+
+double matrix_checksum(acc_t **matrix, int n) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            sum += matrix[i][j];
+        }
+    }
+    return sum;
+}
+
+typedef struct {
+    elem_t **A, **B;
+    acc_t **C;
+    int n;
+} matrix_ctx_t;
+
+static void run_multiply(void *p) {
+    matrix_ctx_t *ctx = (matrix_ctx_t*)p;
+    matrix_multiply(ctx->A, ctx->B, ctx->C, ctx->n);
+}
+
+static void reset_output(void *p) {
+    matrix_ctx_t *ctx = (matrix_ctx_t*)p;
+    zero_matrix(ctx->C, ctx->n);
+}
+
+// Sum of all elements of C for the default seed, the same for every type
+static const harness_ref_t references[] = {
+    {64, 53719.0},
+    {128, 517669.0},
+    {256, 4099752.0},
+    {512, 33790813.0},
+    {0, 0.0}
+};
+
+int main(int argc, char **argv) {
+    harness_t h;
+    harness_init(&h, KERNEL_NAME, argc, argv, SIZE);
+    int n = h.size;
+
+    srand(h.seed);  // Fixed seed for reproducible results
+
+    elem_t **A = (elem_t**)allocate_matrix(n, sizeof(elem_t));
+    elem_t **B = (elem_t**)allocate_matrix(n, sizeof(elem_t));
+    acc_t **C = (acc_t**)allocate_matrix(n, sizeof(acc_t));
+
+    initialize_matrix(A, n);
+    initialize_matrix(B, n);
+
+    matrix_ctx_t ctx = {A, B, C, n};
+    harness_run(&h, run_multiply, reset_output, &ctx);
+    harness_check(&h, matrix_checksum(C, n), references, 0.0);
+
+    // Dumped as doubles (exact) so that every type compares alike
+    double **result = (double**)allocate_matrix(n, sizeof(double));
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            result[i][j] = C[i][j];
+        }
+    }
+    harness_dump(&h, HARNESS_F64, (void *const *)result, n, 0, n);
+
+    printf("Matrix multiplication completed in %f seconds\n", harness_best_time(&h));
+    if (n > 100) {
+        printf("Result checksum: C[0][0] = %.0f, C[100][100] = %.0f\n",
+               result[0][0], result[100][100]);
+    }
+
+    free_matrix((void**)A, n);
+    free_matrix((void**)B, n);
+    free_matrix((void**)C, n);
+    free_matrix((void**)result, n);
+
+    return harness_finish(&h);
+}
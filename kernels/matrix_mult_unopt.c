@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
+
+#include "harness.h"
 
 #define SIZE 256
 
@@ -48,28 +49,67 @@ void zero_matrix(double **matrix, int n) {
     }
 }
 
-int main() {
-    srand(42);  // Fixed seed for reproducible results
+double matrix_checksum(double **matrix, int n) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            sum += matrix[i][j];
+        }
+    }
+    return sum;
+}
+
+typedef struct {
+    double **A, **B, **C;
+    int n;
+} matrix_ctx_t;
+
+static void run_multiply(void *p) {
+    matrix_ctx_t *ctx = (matrix_ctx_t*)p;
+    matrix_multiply(ctx->A, ctx->B, ctx->C, ctx->n);
+}
+
+static void reset_output(void *p) {
+    matrix_ctx_t *ctx = (matrix_ctx_t*)p;
+    zero_matrix(ctx->C, ctx->n);
+}
+
+// Sum of all elements of C for the default seed
+static const harness_ref_t references[] = {
+    {64, 6440146.8699999973},
+    {128, 51231352.890000097},
+    {256, 411458309.32000059},
+    {512, 3280570396.9699998},
+    {0, 0.0}
+};
+
+int main(int argc, char **argv) {
+    harness_t h;
+    harness_init(&h, "matrix_mult_unopt", argc, argv, SIZE);
+    int n = h.size;
+    
+    srand(h.seed);  // Fixed seed for reproducible results
     
-    double **A = allocate_matrix(SIZE);
-    double **B = allocate_matrix(SIZE);
-    double **C = allocate_matrix(SIZE);
+    double **A = allocate_matrix(n);
+    double **B = allocate_matrix(n);
+    double **C = allocate_matrix(n);
     
-    initialize_matrix(A, SIZE);
-    initialize_matrix(B, SIZE);
-    zero_matrix(C, SIZE);
+    initialize_matrix(A, n);
+    initialize_matrix(B, n);
     
-    clock_t start = clock();
-    matrix_multiply(A, B, C, SIZE);
-    clock_t end = clock();
+    matrix_ctx_t ctx = {A, B, C, n};
+    harness_run(&h, run_multiply, reset_output, &ctx);
+    harness_check(&h, matrix_checksum(C, n), references, 1e-9);
+    harness_dump(&h, HARNESS_F64, (void *const *)C, n, 0, n);
     
-    double time_taken = ((double)(end - start)) / CLOCKS_PER_SEC;
-    printf("Matrix multiplication completed in %f seconds\n", time_taken);
-    printf("Result checksum: C[0][0] = %f, C[100][100] = %f\n", C[0][0], C[100][100]);
+    printf("Matrix multiplication completed in %f seconds\n", harness_best_time(&h));
+    if (n > 100) {
+        printf("Result checksum: C[0][0] = %f, C[100][100] = %f\n", C[0][0], C[100][100]);
+    }
     
-    free_matrix(A, SIZE);
-    free_matrix(B, SIZE);
-    free_matrix(C, SIZE);
+    free_matrix(A, n);
+    free_matrix(B, n);
+    free_matrix(C, n);
     
-    return 0;
-}
\ No newline at end of file
+    return harness_finish(&h);
+}
@@ -0,0 +1,104 @@
+#ifndef MORTON_H
+#define MORTON_H
+
+// Block-recursive Z-order (Morton) matrix storage
+//
+// An n x n matrix is padded with zeros to a square of 2^levels tiles per
+// side. Each tile x tile tile is stored contiguously in row-major order, and
+// the tiles follow the Z-order curve: tile (ti, tj) is at position
+// interleave(ti, tj), with the bits of ti above those of tj. The four
+// quadrants of any aligned block of tiles are therefore four consecutive,
+// equally sized ranges (top-left, top-right, bottom-left, bottom-right), so
+// a recursive algorithm works on contiguous memory at every level. The
+// price is padding: just above a power of two tiles, nearly 4x the logical
+// elements are stored (and multiplied as zeros).
+//
+// The functions are static inline so every kernel compiles its own copy, as
+// with blur.h.
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    double *data;                // tiles_per_side^2 tiles of tile^2 elements
+    int n;                       // Logical size
+    int tile;                    // Tile side in elements
+    int tiles_per_side;          // Power of two
+} morton_matrix_t;
+
+// Interleave the bits of ti and tj: ... ti1 tj1 ti0 tj0
+static inline size_t morton_tile_index(int ti, int tj) {
+    size_t z = 0;
+    for (int bit = 0; (ti | tj) >> bit; bit++) {
+        z |= (size_t)((tj >> bit) & 1) << (2 * bit);
+        z |= (size_t)((ti >> bit) & 1) << (2 * bit + 1);
+    }
+    return z;
+}
+
+// Zero-filled matrix; returns 0 on allocation failure
+static inline int morton_alloc(morton_matrix_t *m, int n, int tile) {
+    int tiles = (n + tile - 1) / tile;
+    m->n = n;
+    m->tile = tile;
+    m->tiles_per_side = 1;
+    while (m->tiles_per_side < tiles) {
+        m->tiles_per_side *= 2;
+    }
+    size_t elements = (size_t)m->tiles_per_side * m->tiles_per_side * tile * tile;
+    m->data = (double*)calloc(elements, sizeof(double));
+    return m->data != NULL;
+}
+
+static inline void morton_free(morton_matrix_t *m) {
+    free(m->data);
+    m->data = NULL;
+}
+
+// First element of tile (ti, tj)
+static inline double *morton_tile(const morton_matrix_t *m, int ti, int tj) {
+    return m->data + morton_tile_index(ti, tj) * m->tile * m->tile;
+}
+
+// Element (i, j); for random access only, loops should walk whole tiles
+static inline double *morton_at(const morton_matrix_t *m, int i, int j) {
+    return morton_tile(m, i / m->tile, j / m->tile) + (i % m->tile) * m->tile + j % m->tile;
+}
+
+// Copy a row-major matrix (row pointers, as allocate_matrix) in; the
+// padding stays zero
+static inline void morton_from_rows(morton_matrix_t *m, double **rows) {
+    for (int ti = 0; ti * m->tile < m->n; ti++) {
+        for (int tj = 0; tj * m->tile < m->n; tj++) {
+            double *t = morton_tile(m, ti, tj);
+            int i0 = ti * m->tile;
+            int j0 = tj * m->tile;
+            int width = m->n - j0 < m->tile ? m->n - j0 : m->tile;
+            for (int i = i0; i < i0 + m->tile && i < m->n; i++) {
+                memcpy(t + (i - i0) * m->tile, rows[i] + j0, width * sizeof(double));
+            }
+        }
+    }
+}
+
+// Copy the logical n x n part out to a row-major matrix
+static inline void morton_to_rows(const morton_matrix_t *m, double **rows) {
+    for (int ti = 0; ti * m->tile < m->n; ti++) {
+        for (int tj = 0; tj * m->tile < m->n; tj++) {
+            const double *t = morton_tile(m, ti, tj);
+            int i0 = ti * m->tile;
+            int j0 = tj * m->tile;
+            int width = m->n - j0 < m->tile ? m->n - j0 : m->tile;
+            for (int i = i0; i < i0 + m->tile && i < m->n; i++) {
+                memcpy(rows[i] + j0, t + (i - i0) * m->tile, width * sizeof(double));
+            }
+        }
+    }
+}
+
+static inline void morton_zero(morton_matrix_t *m) {
+    size_t elements = (size_t)m->tiles_per_side * m->tiles_per_side * m->tile * m->tile;
+    memset(m->data, 0, elements * sizeof(double));
+}
+
+#endif
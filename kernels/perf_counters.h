@@ -0,0 +1,60 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+// Native hardware counters via perf_event_open(2)
+//
+// Measures the same region the kernels time with clock() and writes the
+// counts in gem5's stats.txt format, so native runs can be analyzed with
+// the same scripts as simulated ones.
+//
+// Counting is only enabled when the PERF_STATS_FILE environment variable
+// names an output file. Otherwise (and under gem5, where the syscall does
+// not exist) every call is a no-op and the kernel runs unchanged.
+
+#include <stdint.h>
+
+enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_ACCESSES,
+    PERF_L1D_MISSES,
+    PERF_LLC_ACCESSES,
+    PERF_LLC_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_NUM_EVENTS
+};
+
+typedef struct {
+    int fds[PERF_NUM_EVENTS];      // -1 if the event is unavailable
+    uint64_t counts[PERF_NUM_EVENTS];
+    // Fraction of the measured time each event was on the PMU: below 1 when
+    // the kernel multiplexed the events (counts are then scaled up), 0 if it
+    // never ran (no count is reported)
+    double coverage[PERF_NUM_EVENTS];
+    uint64_t enabled_base[PERF_NUM_EVENTS];  // Times at start, which RESET keeps
+    uint64_t running_base[PERF_NUM_EVENTS];
+    const char *output_path;       // NULL if counting is disabled
+} perf_counters_t;
+
+// Open all counters (disabled). Events the CPU or kernel does not support
+// are skipped with a warning on stderr.
+void perf_counters_open(perf_counters_t *pc);
+
+// Reset and enable all counters
+void perf_counters_start(perf_counters_t *pc);
+
+// Stop and restart counting without resetting, to leave out work between
+// measured calls
+void perf_counters_pause(perf_counters_t *pc);
+void perf_counters_resume(perf_counters_t *pc);
+
+// Disable all counters and read their values, scaled by enabled/running
+// time if they were multiplexed (with a warning on stderr)
+void perf_counters_stop(perf_counters_t *pc);
+
+// Write the counts and elapsed time as gem5-style stats to PERF_STATS_FILE
+void perf_counters_report(const perf_counters_t *pc, double seconds);
+
+void perf_counters_close(perf_counters_t *pc);
+
+#endif
@@ -0,0 +1,363 @@
+// Reuse-distance and spatial-locality profiler
+//
+// Kernels are compiled with GCC's -fsanitize=thread instrumentation, which
+// calls __tsan_read<N>/__tsan_write<N> before every load and store. This
+// file implements those hooks (the TSan runtime is not linked) and, while
+// the harness ROI is active, records for each instrumented instruction:
+//   - a log2 histogram of reuse distances, i.e. the number of distinct cache
+//     lines touched since the previous access to the same line, computed
+//     exactly with a Fenwick tree over access times (Bennett-Kruskal)
+//   - cold (first-touch) accesses
+//   - a spatial-locality score: the fraction of consecutive accesses by the
+//     instruction that stay within one cache line of the previous one
+//   - its most frequent stride
+//
+// Results are written to REUSE_PROFILE_FILE (default: reuse_profile.txt)
+// and mapped to source lines by scripts/reuse_report.py. The line size can
+// be changed with REUSE_LINE_SIZE (default: 64 bytes).
+//
+// If REUSE_TRACE_FILE is set, every access is also written there as a
+// 64-bit record (byte address, bit 63 set for stores) for the cache model
+// in cachesim/.
+
+#include "reuse_profile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define NUM_BUCKETS 32           // Bucket b holds distances in [2^(b-1), 2^b)
+#define TIME_CAPACITY (1 << 22)  // Fenwick tree size before timestamps are compacted
+#define TRACE_BUFFER 4096
+#define TRACE_WRITE_BIT (1ULL << 63)
+
+typedef struct {
+    uintptr_t line;
+    uint64_t time;               // 0 = empty slot
+} line_entry_t;
+
+typedef struct {
+    uintptr_t pc;                // 0 = empty slot
+    uint64_t accesses;
+    uint64_t writes;
+    uint64_t cold;
+    uint64_t hist[NUM_BUCKETS];
+    uintptr_t last_addr;
+    uint64_t near_accesses;      // Within one line of the previous access
+    intptr_t top_stride;         // Majority-vote estimate of the dominant stride
+    int64_t top_votes;
+} pc_stats_t;
+
+static int active = 0;
+static int line_shift = 6;
+
+// Fenwick tree over access times; a time is marked while it is the most
+// recent access of some line, so the marks after t count distinct lines
+static int32_t *fenwick = NULL;
+static uint64_t now = 0;
+static uint64_t total_accesses = 0;
+
+static line_entry_t *lines = NULL;
+static size_t lines_capacity = 0;
+static size_t lines_used = 0;
+
+static pc_stats_t *pcs = NULL;
+static size_t pcs_capacity = 0;
+static size_t pcs_used = 0;
+
+static FILE *trace_file = NULL;
+static uint64_t trace_buffer[TRACE_BUFFER];
+static size_t trace_used = 0;
+
+static size_t hash_ptr(uintptr_t x, size_t capacity) {
+    return (size_t)((x * 0x9E3779B97F4A7C15ULL) >> 16) & (capacity - 1);
+}
+
+static void fenwick_add(uint64_t t, int32_t delta) {
+    for (; t <= TIME_CAPACITY; t += t & (~t + 1)) {
+        fenwick[t] += delta;
+    }
+}
+
+static int64_t fenwick_sum(uint64_t t) {
+    int64_t sum = 0;
+    for (; t > 0; t -= t & (~t + 1)) {
+        sum += fenwick[t];
+    }
+    return sum;
+}
+
+static line_entry_t *find_line(uintptr_t line);
+
+static void grow_lines(void) {
+    line_entry_t *old = lines;
+    size_t old_capacity = lines_capacity;
+
+    lines_capacity = lines_capacity ? lines_capacity * 2 : 1 << 16;
+    lines = (line_entry_t*)calloc(lines_capacity, sizeof(line_entry_t));
+    if (!lines) {
+        fprintf(stderr, "reuse_profile: out of memory\n");
+        exit(1);
+    }
+    lines_used = 0;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old[i].time) {
+            *find_line(old[i].line) = old[i];
+        }
+    }
+    free(old);
+}
+
+// Return the entry for a line, inserting an empty one if needed
+static line_entry_t *find_line(uintptr_t line) {
+    if (2 * (lines_used + 1) > lines_capacity) {
+        grow_lines();
+    }
+    size_t i = hash_ptr(line, lines_capacity);
+    while (lines[i].time && lines[i].line != line) {
+        i = (i + 1) & (lines_capacity - 1);
+    }
+    if (!lines[i].time) {
+        lines[i].line = line;
+        lines_used++;
+    }
+    return &lines[i];
+}
+
+static int compare_times(const void *a, const void *b) {
+    uint64_t x = (*(line_entry_t *const *)a)->time;
+    uint64_t y = (*(line_entry_t *const *)b)->time;
+    return (x > y) - (x < y);
+}
+
+// Renumber the live timestamps 1..lines_used, preserving their order, so the
+// Fenwick tree stays bounded however long the kernel runs
+static void compact_times(void) {
+    line_entry_t **live = (line_entry_t**)malloc(lines_used * sizeof(line_entry_t*));
+    if (!live) {
+        fprintf(stderr, "reuse_profile: out of memory\n");
+        exit(1);
+    }
+    size_t n = 0;
+    for (size_t i = 0; i < lines_capacity; i++) {
+        if (lines[i].time) {
+            live[n++] = &lines[i];
+        }
+    }
+    qsort(live, n, sizeof(line_entry_t*), compare_times);
+
+    memset(fenwick, 0, (TIME_CAPACITY + 1) * sizeof(int32_t));
+    for (size_t i = 0; i < n; i++) {
+        live[i]->time = i + 1;
+        fenwick_add(i + 1, 1);
+    }
+    now = n;
+    free(live);
+
+    if (now >= TIME_CAPACITY / 2) {
+        fprintf(stderr, "reuse_profile: working set too large (%zu lines)\n", n);
+        exit(1);
+    }
+}
+
+static pc_stats_t *find_pc(uintptr_t pc) {
+    if (2 * (pcs_used + 1) > pcs_capacity) {
+        pc_stats_t *old = pcs;
+        size_t old_capacity = pcs_capacity;
+        pcs_capacity = pcs_capacity ? pcs_capacity * 2 : 1024;
+        pcs = (pc_stats_t*)calloc(pcs_capacity, sizeof(pc_stats_t));
+        pcs_used = 0;
+        for (size_t i = 0; i < old_capacity; i++) {
+            if (old[i].pc) {
+                *find_pc(old[i].pc) = old[i];
+            }
+        }
+        free(old);
+    }
+    size_t i = hash_ptr(pc, pcs_capacity);
+    while (pcs[i].pc && pcs[i].pc != pc) {
+        i = (i + 1) & (pcs_capacity - 1);
+    }
+    if (!pcs[i].pc) {
+        pcs[i].pc = pc;
+        pcs_used++;
+    }
+    return &pcs[i];
+}
+
+static void flush_trace(void) {
+    if (trace_used && fwrite(trace_buffer, sizeof(uint64_t), trace_used, trace_file) != trace_used) {
+        fprintf(stderr, "reuse_profile: error writing trace\n");
+        exit(1);
+    }
+    trace_used = 0;
+}
+
+static void record(uintptr_t pc, uintptr_t addr, int is_write) {
+    if (!active) {
+        return;
+    }
+    if (trace_file) {
+        trace_buffer[trace_used++] = (uint64_t)addr | (is_write ? TRACE_WRITE_BIT : 0);
+        if (trace_used == TRACE_BUFFER) {
+            flush_trace();
+        }
+    }
+    if (now + 1 > TIME_CAPACITY) {
+        compact_times();
+    }
+    now++;
+    total_accesses++;
+
+    pc_stats_t *s = find_pc(pc);
+    s->accesses++;
+    s->writes += is_write;
+
+    // Reuse distance at line granularity
+    line_entry_t *e = find_line(addr >> line_shift);
+    if (e->time == 0) {
+        s->cold++;
+    } else {
+        int64_t distance = fenwick_sum(now - 1) - fenwick_sum(e->time);
+        int bucket = 0;
+        while (bucket < NUM_BUCKETS - 1 && ((int64_t)1 << bucket) <= distance) {
+            bucket++;
+        }
+        s->hist[bucket]++;
+        fenwick_add(e->time, -1);
+    }
+    e->time = now;
+    fenwick_add(now, 1);
+
+    // Spatial locality and stride of this instruction's address stream
+    if (s->accesses > 1) {
+        intptr_t stride = (intptr_t)(addr - s->last_addr);
+        intptr_t line_size = (intptr_t)1 << line_shift;
+        if (stride > -line_size && stride < line_size) {
+            s->near_accesses++;
+        }
+        if (s->top_votes == 0) {
+            s->top_stride = stride;
+        }
+        s->top_votes += stride == s->top_stride ? 1 : -1;
+    }
+    s->last_addr = addr;
+}
+
+void reuse_profile_begin(void) {
+    const char *line_size = getenv("REUSE_LINE_SIZE");
+    if (line_size) {
+        int bytes = atoi(line_size);
+        line_shift = 0;
+        while (bytes > 1) {
+            bytes >>= 1;
+            line_shift++;
+        }
+    }
+    if (!fenwick) {
+        fenwick = (int32_t*)calloc(TIME_CAPACITY + 1, sizeof(int32_t));
+        if (!fenwick) {
+            fprintf(stderr, "reuse_profile: out of memory\n");
+            exit(1);
+        }
+    }
+    const char *trace_path = getenv("REUSE_TRACE_FILE");
+    if (trace_path && !trace_file) {
+        trace_file = fopen(trace_path, "wb");
+        if (!trace_file) {
+            fprintf(stderr, "reuse_profile: cannot write %s\n", trace_path);
+            exit(1);
+        }
+    }
+    active = 1;
+}
+
+void reuse_profile_pause(void) {
+    active = 0;
+}
+
+void reuse_profile_resume(void) {
+    active = 1;
+}
+
+void reuse_profile_end(void) {
+    active = 0;
+
+    if (trace_file) {
+        flush_trace();
+        fclose(trace_file);
+        trace_file = NULL;
+        fprintf(stderr, "Memory trace written to %s\n", getenv("REUSE_TRACE_FILE"));
+    }
+
+    const char *path = getenv("REUSE_PROFILE_FILE");
+    if (!path) {
+        path = "reuse_profile.txt";
+    }
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "reuse_profile: cannot write %s\n", path);
+        return;
+    }
+
+    fprintf(f, "# reuse profile: line_size %d, accesses %llu, distinct lines %zu\n",
+            1 << line_shift, (unsigned long long)total_accesses, lines_used);
+    fprintf(f, "# pc accesses writes cold near_accesses top_stride hist[0..%d]\n", NUM_BUCKETS - 1);
+    for (size_t i = 0; i < pcs_capacity; i++) {
+        pc_stats_t *s = &pcs[i];
+        if (!s->pc) {
+            continue;
+        }
+        fprintf(f, "0x%lx %llu %llu %llu %llu %ld", (unsigned long)s->pc,
+                (unsigned long long)s->accesses, (unsigned long long)s->writes,
+                (unsigned long long)s->cold, (unsigned long long)s->near_accesses,
+                (long)s->top_stride);
+        for (int b = 0; b < NUM_BUCKETS; b++) {
+            fprintf(f, " %llu", (unsigned long long)s->hist[b]);
+        }
+        fprintf(f, "\n");
+    }
+    fclose(f);
+    fprintf(stderr, "Reuse profile written to %s\n", path);
+}
+
+// Instrumentation hooks called by -fsanitize=thread code
+#define RECORD(addr, is_write) \
+    record((uintptr_t)__builtin_return_address(0), (uintptr_t)(addr), (is_write))
+
+#define DEFINE_HOOKS(size) \
+    void __tsan_read##size(void *addr) { RECORD(addr, 0); } \
+    void __tsan_write##size(void *addr) { RECORD(addr, 1); } \
+    void __tsan_unaligned_read##size(void *addr) { RECORD(addr, 0); } \
+    void __tsan_unaligned_write##size(void *addr) { RECORD(addr, 1); } \
+    void __tsan_volatile_read##size(void *addr) { RECORD(addr, 0); } \
+    void __tsan_volatile_write##size(void *addr) { RECORD(addr, 1); }
+
+DEFINE_HOOKS(1)
+DEFINE_HOOKS(2)
+DEFINE_HOOKS(4)
+DEFINE_HOOKS(8)
+DEFINE_HOOKS(16)
+
+// One access per cache line the range covers, at addr in the first line and
+// at the start of every following one
+static void record_range(uintptr_t pc, uintptr_t addr, unsigned long size, int is_write) {
+    if (size == 0) {
+        return;
+    }
+    uintptr_t last = (addr + size - 1) >> line_shift;
+    for (uintptr_t line = addr >> line_shift; line <= last; line++) {
+        record(pc, line == addr >> line_shift ? addr : line << line_shift, is_write);
+    }
+}
+
+void __tsan_read_range(void *addr, unsigned long size) {
+    record_range((uintptr_t)__builtin_return_address(0), (uintptr_t)addr, size, 0);
+}
+void __tsan_write_range(void *addr, unsigned long size) {
+    record_range((uintptr_t)__builtin_return_address(0), (uintptr_t)addr, size, 1);
+}
+void __tsan_init(void) {}
+void __tsan_func_entry(void *pc) { (void)pc; }
+void __tsan_func_exit(void) {}
@@ -0,0 +1,15 @@
+#ifndef REUSE_PROFILE_H
+#define REUSE_PROFILE_H
+
+// Reuse-distance profiler (see reuse_profile.c), enabled in the harness ROI
+// when built with -DREUSE_PROFILE ("make reuse")
+
+void reuse_profile_begin(void);
+void reuse_profile_end(void);
+
+// Stop and restart recording within the ROI (accesses in between are not
+// profiled or traced)
+void reuse_profile_pause(void);
+void reuse_profile_resume(void);
+
+#endif
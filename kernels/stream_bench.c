@@ -1,10 +1,22 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
+#include "harness.h"
+
 #define ARRAY_SIZE (1024 * 1024)  // 1M elements
 #define REPEAT_COUNT 10
 
+// Software prefetch (--prefetch <bytes>): the prefetching kernels issue one
+// prefetch per stream every PREFETCH_STRIDE elements (a 64-byte line), the
+// given distance ahead of the element being processed
+#define PREFETCH_STRIDE 8
+
+// Distances in bytes run by --prefetch-sweep; 0 runs the plain kernels
+static const int prefetch_sweep[] = {0, 64, 128, 192, 256, 384, 512, 768, 1024};
+#define PREFETCH_SWEEP_POINTS (int)(sizeof(prefetch_sweep) / sizeof(prefetch_sweep[0]))
+
 // Stream benchmark - tests memory bandwidth
 void stream_copy(double *a, double *b, int n) {
     for (int i = 0; i < n; i++) {
@@ -30,6 +42,74 @@ void stream_triad(double *a, double *b, double *c, double scalar, int n) {
     }
 }
 
+// Index of the element to prefetch for element i, clamped to the array so
+// the address stays valid
+static inline int prefetch_index(int i, int ahead, int n) {
+    return i + ahead < n ? i + ahead : n - 1;
+}
+
+void stream_copy_prefetch(double *a, double *b, int n, int ahead) {
+    int i = 0;
+    for (; i + PREFETCH_STRIDE <= n; i += PREFETCH_STRIDE) {
+        int p = prefetch_index(i, ahead, n);
+        __builtin_prefetch(&a[p], 0);
+        __builtin_prefetch(&b[p], 1);
+        for (int j = i; j < i + PREFETCH_STRIDE; j++) {
+            b[j] = a[j];
+        }
+    }
+    for (; i < n; i++) {
+        b[i] = a[i];
+    }
+}
+
+void stream_scale_prefetch(double *a, double *b, double scalar, int n, int ahead) {
+    int i = 0;
+    for (; i + PREFETCH_STRIDE <= n; i += PREFETCH_STRIDE) {
+        int p = prefetch_index(i, ahead, n);
+        __builtin_prefetch(&a[p], 0);
+        __builtin_prefetch(&b[p], 1);
+        for (int j = i; j < i + PREFETCH_STRIDE; j++) {
+            b[j] = scalar * a[j];
+        }
+    }
+    for (; i < n; i++) {
+        b[i] = scalar * a[i];
+    }
+}
+
+void stream_add_prefetch(double *a, double *b, double *c, int n, int ahead) {
+    int i = 0;
+    for (; i + PREFETCH_STRIDE <= n; i += PREFETCH_STRIDE) {
+        int p = prefetch_index(i, ahead, n);
+        __builtin_prefetch(&a[p], 0);
+        __builtin_prefetch(&b[p], 0);
+        __builtin_prefetch(&c[p], 1);
+        for (int j = i; j < i + PREFETCH_STRIDE; j++) {
+            c[j] = a[j] + b[j];
+        }
+    }
+    for (; i < n; i++) {
+        c[i] = a[i] + b[i];
+    }
+}
+
+void stream_triad_prefetch(double *a, double *b, double *c, double scalar, int n, int ahead) {
+    int i = 0;
+    for (; i + PREFETCH_STRIDE <= n; i += PREFETCH_STRIDE) {
+        int p = prefetch_index(i, ahead, n);
+        __builtin_prefetch(&a[p], 1);
+        __builtin_prefetch(&b[p], 0);
+        __builtin_prefetch(&c[p], 0);
+        for (int j = i; j < i + PREFETCH_STRIDE; j++) {
+            a[j] = b[j] + scalar * c[j];
+        }
+    }
+    for (; i < n; i++) {
+        a[i] = b[i] + scalar * c[i];
+    }
+}
+
 void initialize_arrays(double *a, double *b, double *c, int n) {
     for (int i = 0; i < n; i++) {
         a[i] = 1.0;
@@ -38,42 +118,225 @@ void initialize_arrays(double *a, double *b, double *c, int n) {
     }
 }
 
-int main() {
-    double *a = (double*)malloc(ARRAY_SIZE * sizeof(double));
-    double *b = (double*)malloc(ARRAY_SIZE * sizeof(double));
-    double *c = (double*)malloc(ARRAY_SIZE * sizeof(double));
+double arrays_checksum(double *a, double *b, double *c, int n) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        sum += a[i] + b[i] + c[i];
+    }
+    return sum;
+}
+
+enum { COPY, SCALE, ADD, TRIAD, STREAM_KERNELS };
+static const char *const kernel_names[STREAM_KERNELS] = {"Copy", "Scale", "Add", "Triad"};
+static const int kernel_arrays[STREAM_KERNELS] = {2, 2, 3, 3};   // Arrays each kernel touches
+
+typedef struct {
+    double *a, *b, *c;
+    int n;
+    int ahead;                          // Prefetch distance in elements, 0 = none
+    int timed;                          // Time each kernel (--prefetch-sweep)
+    double seconds[STREAM_KERNELS];     // Per-kernel time of the last run
+    double best[STREAM_KERNELS];        // Per-kernel best over the timed runs
+    int warmup;                         // Runs before the timed ones (h.warmup)
+    int calls;
+} stream_ctx_t;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void run_kernel(stream_ctx_t *ctx, int kernel) {
+    int n = ctx->n;
+    int ahead = ctx->ahead;
+    switch (kernel) {
+    case COPY:
+        ahead ? stream_copy_prefetch(ctx->a, ctx->c, n, ahead) : stream_copy(ctx->a, ctx->c, n);
+        break;
+    case SCALE:
+        ahead ? stream_scale_prefetch(ctx->c, ctx->b, 2.5, n, ahead) : stream_scale(ctx->c, ctx->b, 2.5, n);
+        break;
+    case ADD:
+        ahead ? stream_add_prefetch(ctx->a, ctx->b, ctx->c, n, ahead) : stream_add(ctx->a, ctx->b, ctx->c, n);
+        break;
+    default:
+        ahead ? stream_triad_prefetch(ctx->a, ctx->b, ctx->c, 1.5, n, ahead)
+              : stream_triad(ctx->a, ctx->b, ctx->c, 1.5, n);
+        break;
+    }
+}
+
+static void run_stream(void *p) {
+    stream_ctx_t *ctx = (stream_ctx_t*)p;
+    
+    // Run stream operations multiple times
+    memset(ctx->seconds, 0, sizeof(ctx->seconds));
+    for (int rep = 0; rep < REPEAT_COUNT; rep++) {
+        for (int k = 0; k < STREAM_KERNELS; k++) {
+            double start = ctx->timed ? now_seconds() : 0.0;
+            run_kernel(ctx, k);
+            if (ctx->timed) {
+                ctx->seconds[k] += now_seconds() - start;
+            }
+        }
+    }
+    // Warmup runs are not measurements, as in the harness
+    for (int k = 0; k < STREAM_KERNELS && ctx->calls >= ctx->warmup; k++) {
+        if (ctx->timed && (ctx->best[k] == 0.0 || ctx->seconds[k] < ctx->best[k])) {
+            ctx->best[k] = ctx->seconds[k];
+        }
+    }
+    ctx->calls++;
+}
+
+static void reset_arrays(void *p) {
+    stream_ctx_t *ctx = (stream_ctx_t*)p;
+    initialize_arrays(ctx->a, ctx->b, ctx->c, ctx->n);
+}
+
+// Sum of a, b and c after REPEAT_COUNT iterations (size = elements per array)
+static const harness_ref_t references[] = {
+    {1024, 1420096893395.4226},
+    {65536, 90886201177182.391},
+    {1048576, 1454179218862040.8},
+    {4194304, 5816716875036291.0},
+    {0, 0.0}
+};
+
+// Options of this kernel, removed from argv before harness_init
+static void parse_prefetch_options(int *argc, char **argv, int *distance, int *sweep) {
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        const char *value = i + 1 < *argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--prefetch") == 0) {
+            char *end;
+            long bytes = value ? strtol(value, &end, 10) : -1;
+            // The kernels prefetch whole elements ahead
+            if (!value || *end != '\0' || bytes < 0 || bytes > (1 << 24) ||
+                bytes % (long)sizeof(double) != 0) {
+                fprintf(stderr, "%s: --prefetch expects a distance in bytes >= 0, "
+                        "a multiple of %zu\n", argv[0], sizeof(double));
+                exit(2);
+            }
+            *distance = (int)bytes;
+            i++;
+        } else if (strcmp(argv[i], "--prefetch-sweep") == 0) {
+            *sweep = 1;
+        } else {
+            if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+                printf("stream_bench options:\n");
+                printf("  --prefetch <bytes> Software prefetch distance, a multiple of %zu (default: 0, no prefetch)\n",
+                       sizeof(double));
+                printf("  --prefetch-sweep   Report bandwidth at distances 0 to 1024 bytes first\n");
+            }
+            argv[kept++] = argv[i];
+        }
+    }
+    *argc = kept;
+    argv[kept] = NULL;
+}
+
+static double gigabytes_per_second(int arrays, int n, double seconds) {
+    long long total_bytes = (long long)n * sizeof(double) * arrays * REPEAT_COUNT;
+    return (total_bytes / (1024.0 * 1024.0 * 1024.0)) / seconds;
+}
+
+// One harness run per distance, so a gem5 build with ROI markers dumps one
+// stats block per distance (in prefetch_sweep order)
+static void prefetch_sweep_report(harness_t *h, stream_ctx_t *ctx) {
+    double no_prefetch = 0.0;
+    double best = 0.0;
+    int best_distance = 0;
+
+    printf("Software prefetch sweep (%d elements per array, GB/s):\n", ctx->n);
+    printf("%-10s", "Distance");
+    for (int k = 0; k < STREAM_KERNELS; k++) {
+        printf(" %9s", kernel_names[k]);
+    }
+    printf(" %9s\n", "All");
+    for (int d = 0; d < PREFETCH_SWEEP_POINTS; d++) {
+        ctx->ahead = prefetch_sweep[d] / (int)sizeof(double);
+        memset(ctx->best, 0, sizeof(ctx->best));
+        ctx->warmup = h->warmup;
+        ctx->calls = 0;
+        harness_run(h, run_stream, reset_arrays, ctx);
+
+        double total = harness_best_time(h);
+        double all = gigabytes_per_second(10, ctx->n, total);
+        printf("%-10d", prefetch_sweep[d]);
+        for (int k = 0; k < STREAM_KERNELS; k++) {
+            printf(" %9.2f", gigabytes_per_second(kernel_arrays[k], ctx->n, ctx->best[k]));
+        }
+        printf(" %9.2f\n", all);
+
+        if (d == 0) {
+            no_prefetch = all;
+        }
+        if (all > best) {
+            best = all;
+            best_distance = prefetch_sweep[d];
+        }
+    }
+    printf("Best distance: %d bytes, %.2fx the bandwidth without prefetch\n",
+           best_distance, best / no_prefetch);
+}
+
+int main(int argc, char **argv) {
+    int prefetch_distance = 0;
+    int sweep = 0;
+    parse_prefetch_options(&argc, argv, &prefetch_distance, &sweep);
+
+    harness_t h;
+    harness_init(&h, "stream_bench", argc, argv, ARRAY_SIZE);
+    int n = h.size;
+    
+    double *a = (double*)malloc(n * sizeof(double));
+    double *b = (double*)malloc(n * sizeof(double));
+    double *c = (double*)malloc(n * sizeof(double));
     
     if (!a || !b || !c) {
         printf("Memory allocation failed\n");
         return 1;
     }
     
-    initialize_arrays(a, b, c, ARRAY_SIZE);
-    
-    clock_t start = clock();
-    
-    // Run stream operations multiple times
-    for (int rep = 0; rep < REPEAT_COUNT; rep++) {
-        stream_copy(a, c, ARRAY_SIZE);
-        stream_scale(c, b, 2.5, ARRAY_SIZE);
-        stream_add(a, b, c, ARRAY_SIZE);
-        stream_triad(a, b, c, 1.5, ARRAY_SIZE);
+    stream_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.a = a;
+    ctx.b = b;
+    ctx.c = c;
+    ctx.n = n;
+    if (sweep) {
+        ctx.timed = 1;
+        prefetch_sweep_report(&h, &ctx);
+        ctx.timed = 0;
     }
+
+    // The measured run, whose results the harness reports and verifies
+    ctx.ahead = prefetch_distance / (int)sizeof(double);
+    harness_run(&h, run_stream, reset_arrays, &ctx);
+    harness_check(&h, arrays_checksum(a, b, c, n), references, 1e-12);
+    harness_dump(&h, HARNESS_F64, (void *const *)&a, 1, 0, n);
+    harness_dump(&h, HARNESS_F64, (void *const *)&b, 1, 0, n);
+    harness_dump(&h, HARNESS_F64, (void *const *)&c, 1, 0, n);
     
-    clock_t end = clock();
-    
-    double time_taken = ((double)(end - start)) / CLOCKS_PER_SEC;
-    printf("Stream benchmark completed in %f seconds\n", time_taken);
-    printf("Final result checksum: a[100] = %f, b[100] = %f\n", a[100], b[100]);
+    double time_taken = harness_best_time(&h);
+    printf("Stream benchmark completed in %f seconds", time_taken);
+    if (ctx.ahead > 0) {
+        printf(" (software prefetch %d bytes ahead)", ctx.ahead * (int)sizeof(double));
+    }
+    printf("\n");
+    if (n > 100) {
+        printf("Final result checksum: a[100] = %f, b[100] = %f\n", a[100], b[100]);
+    }
     
     // Calculate approximate memory bandwidth
-    long long total_bytes = (long long)ARRAY_SIZE * sizeof(double) * 10 * REPEAT_COUNT;  // 10 arrays accessed per repeat
-    double bandwidth_gb_s = (total_bytes / (1024.0 * 1024.0 * 1024.0)) / time_taken;
+    double bandwidth_gb_s = gigabytes_per_second(10, n, time_taken);  // 10 arrays accessed per repeat
     printf("Approximate memory bandwidth: %.2f GB/s\n", bandwidth_gb_s);
     
     free(a);
     free(b);
     free(c);
     
-    return 0;
-}
\ No newline at end of file
+    return harness_finish(&h);
+}
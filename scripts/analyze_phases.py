@@ -0,0 +1,270 @@
+#!/usr/bin/env python3
+
+"""
+Phase detection and bottleneck classification from periodic gem5 stats dumps.
+
+Runs made with "cache_experiment.py --stats_period <ticks>" (or
+"run_cache_sweep.sh -p <ticks>") write one stats block per interval. This
+script computes IPC, L1D/L2 MPKI and DRAM bandwidth and queueing for every
+interval, estimates where its cycles went, and groups consecutive intervals
+into phases.
+
+The CPU is a TimingSimpleCPU, which blocks on every memory access, so the
+cycles of an interval split into:
+  L1      L1D accesses x L1 hit latency
+  L2      L1D misses served by the L2 x L2 latency
+  DRAM    L2 misses x (L2 latency + measured DRAM access latency)
+  compute the remaining cycles
+Each interval is labelled by its largest share (compute-, L1-, L2- or
+DRAM-bound). With --summary, the time-weighted shares of every run show
+which level a larger L1D would relieve: a DRAM-bound streaming kernel gains
+nothing, while a kernel bound by L1D misses keeps improving.
+"""
+
+import os
+import sys
+import argparse
+from collections import defaultdict
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, SCRIPT_DIR)
+
+from analyze_results import parse_stats_dumps, extract_config_from_path, config_sort_key
+
+# Ticks per CPU cycle at the 2GHz clock of cache_experiment.py
+TICKS_PER_CYCLE = 500
+
+# Peak bandwidth of the DDR3_1600_8x8 memory in cache_experiment.py
+DRAM_PEAK_GBPS = 12.8
+
+CLASSES = ['compute', 'L1', 'L2', 'DRAM']
+
+# Stat names differ between gem5 versions; the first one present is used
+STAT_NAMES = {
+    'insts': ['system.cpu.committedInsts', 'system.cpu.exec_context.thread_0.numInsts',
+              'system.cpu.numInsts'],
+    'cycles': ['system.cpu.numCycles'],
+    'l1d_accesses': ['system.cpu.dcache.overall_accesses::total', 'system.cpu.dcache.overallAccesses::total'],
+    'l1d_misses': ['system.cpu.dcache.overall_misses::total', 'system.cpu.dcache.overallMisses::total'],
+    'l2_misses': ['system.l2cache.overall_misses::total', 'system.l2cache.overallMisses::total'],
+    'dram_bytes_read': ['system.mem_ctrl.dram.bytesRead::total', 'system.mem_ctrl.bytesReadSys',
+                        'system.mem_ctrl.bytes_read::total'],
+    'dram_bytes_written': ['system.mem_ctrl.dram.bytesWritten::total', 'system.mem_ctrl.bytesWrittenSys',
+                           'system.mem_ctrl.bytes_written::total'],
+    'dram_latency': ['system.mem_ctrl.dram.avgMemAccLat', 'system.mem_ctrl.avgMemAccLat'],
+    'read_queue': ['system.mem_ctrl.avgRdQLen'],
+    'write_queue': ['system.mem_ctrl.avgWrQLen'],
+}
+
+def get_stat(stats, name, default=0.0):
+    for key in STAT_NAMES[name]:
+        value = stats.get(key)
+        if isinstance(value, float) and value == value:
+            return value
+    return default
+
+def interval_metrics(dumps, args):
+    """Per-interval metrics and cycle breakdown"""
+    # sim_insts counts from the start of the simulation; fall back to its
+    # differences when the per-CPU instruction count is not available
+    previous_insts = 0.0
+    intervals = []
+    start_ticks = 0.0
+    for stats in dumps:
+        ticks = stats.get('sim_ticks', 0.0)
+        insts = get_stat(stats, 'insts')
+        if 'sim_insts' in stats:
+            if not insts:
+                insts = stats['sim_insts'] - previous_insts
+            previous_insts = stats['sim_insts']
+        cycles = get_stat(stats, 'cycles') or ticks / TICKS_PER_CYCLE
+        if cycles <= 0:
+            continue
+
+        l1d_accesses = get_stat(stats, 'l1d_accesses')
+        l1d_misses = get_stat(stats, 'l1d_misses')
+        l2_misses = get_stat(stats, 'l2_misses')
+        dram_latency = get_stat(stats, 'dram_latency') / TICKS_PER_CYCLE or args.dram_latency
+        seconds = ticks * 1e-12
+        dram_bytes = get_stat(stats, 'dram_bytes_read') + get_stat(stats, 'dram_bytes_written')
+
+        stalls = {
+            'L1': l1d_accesses * args.l1_latency,
+            'L2': max(l1d_misses - l2_misses, 0) * args.l2_latency,
+            'DRAM': l2_misses * (args.l2_latency + dram_latency),
+        }
+        # Latencies are estimates; never attribute more than the interval
+        scale = min(1.0, cycles / max(sum(stalls.values()), 1))
+        shares = {level: stall * scale / cycles for level, stall in stalls.items()}
+        shares['compute'] = max(0.0, 1 - sum(shares.values()))
+
+        intervals.append({
+            'start_ms': start_ticks * 1e-9,
+            'ms': ticks * 1e-9,
+            'insts': insts,
+            'cycles': cycles,
+            'ipc': insts / cycles,
+            'l1d_mpki': l1d_misses * 1000 / insts if insts else 0.0,
+            'l2_mpki': l2_misses * 1000 / insts if insts else 0.0,
+            'dram_gbps': dram_bytes / seconds / 1e9 if seconds else 0.0,
+            'read_queue': get_stat(stats, 'read_queue'),
+            'shares': shares,
+            'bound': max(shares, key=shares.get),
+        })
+        start_ticks += ticks
+    return intervals
+
+def segment_phases(intervals, threshold, min_intervals):
+    """Group consecutive intervals into phases.
+
+    A new phase starts when the bottleneck class changes or the IPC moves
+    more than threshold (relative) away from the current phase's mean.
+    Phases shorter than min_intervals are merged into the previous phase.
+    """
+    phases = []
+    for interval in intervals:
+        if phases:
+            phase = phases[-1]
+            mean_ipc = sum(i['ipc'] for i in phase) / len(phase)
+            same_ipc = abs(interval['ipc'] - mean_ipc) <= threshold * max(mean_ipc, 1e-9)
+            if interval['bound'] == phase[0]['bound'] and same_ipc:
+                phase.append(interval)
+                continue
+        phases.append([interval])
+
+    merged = []
+    for phase in phases:
+        if merged and len(phase) < min_intervals:
+            merged[-1].extend(phase)
+        else:
+            merged.append(phase)
+    if len(merged) > 1 and len(merged[0]) < min_intervals:
+        merged[1] = merged[0] + merged[1]
+        merged.pop(0)
+    return merged
+
+def summarize(intervals):
+    """Cycle-weighted metrics of a list of intervals"""
+    cycles = sum(i['cycles'] for i in intervals)
+    insts = sum(i['insts'] for i in intervals)
+    ms = sum(i['ms'] for i in intervals)
+    shares = {c: sum(i['shares'][c] * i['cycles'] for i in intervals) / cycles for c in CLASSES}
+    return {
+        'start_ms': intervals[0]['start_ms'],
+        'ms': ms,
+        'insts': insts,
+        'ipc': insts / cycles,
+        'l1d_mpki': sum(i['l1d_mpki'] * i['insts'] for i in intervals) / insts if insts else 0.0,
+        'l2_mpki': sum(i['l2_mpki'] * i['insts'] for i in intervals) / insts if insts else 0.0,
+        'dram_gbps': sum(i['dram_gbps'] * i['ms'] for i in intervals) / ms if ms else 0.0,
+        'read_queue': sum(i['read_queue'] * i['ms'] for i in intervals) / ms if ms else 0.0,
+        'shares': shares,
+        'bound': max(shares, key=shares.get),
+    }
+
+def format_shares(shares):
+    return ' '.join(f"{shares[c] * 100:>6.1f}" for c in CLASSES)
+
+def print_phases(run_path, phases, num_intervals):
+    print(f"\n{'='*100}")
+    print(f"Phases: {run_path} ({num_intervals} intervals)")
+    print(f"{'='*100}")
+    print(f"{'#':<3} {'Start ms':>9} {'Len ms':>8} {'IPC':>6} {'L1D MPKI':>9} {'L2 MPKI':>8} "
+          f"{'DRAM GB/s':>9} {'RdQ':>5}  {'Bound':<8} {'compute%':>8} {'L1%':>6} {'L2%':>6} {'DRAM%':>6}")
+    print("-" * 100)
+    for index, phase in enumerate(phases):
+        s = summarize(phase)
+        print(f"{index:<3} {s['start_ms']:>9.3f} {s['ms']:>8.3f} {s['ipc']:>6.3f} {s['l1d_mpki']:>9.2f} "
+              f"{s['l2_mpki']:>8.2f} {s['dram_gbps']:>9.2f} {s['read_queue']:>5.2f}  {s['bound']:<8} "
+              f"{format_shares(s['shares']):>29}")
+
+        # Saturated memory: queueing and bandwidth close to peak
+        if s['bound'] == 'DRAM' and s['dram_gbps'] > 0.7 * DRAM_PEAK_GBPS:
+            print(f"    bandwidth-bound: {s['dram_gbps'] / DRAM_PEAK_GBPS * 100:.0f}% of the "
+                  f"{DRAM_PEAK_GBPS} GB/s DRAM peak")
+
+def print_summary(runs):
+    """Time-weighted bottleneck shares per run, grouped by application"""
+    by_app = defaultdict(list)
+    for path, config, overall in runs:
+        by_app[config.get('application', 'unknown')].append((path, config, overall))
+
+    print(f"\n{'='*90}")
+    print("BOTTLENECK SUMMARY (share of cycles)")
+    print(f"{'='*90}")
+    for app, app_runs in sorted(by_app.items()):
+        print(f"\n{app.upper()}:")
+        print(f"{'Run':<32} {'IPC':>6} {'L1D MPKI':>9} {'L2 MPKI':>8} {'Bound':<8} "
+              f"{'compute%':>8} {'L1%':>6} {'L2%':>6} {'DRAM%':>6}")
+        print("-" * 90)
+        app_runs.sort(key=lambda r: (config_sort_key(r[1].get('cache_size', '')),
+                                     r[1].get('associativity', 0), r[0]))
+        for path, config, s in app_runs:
+            print(f"{os.path.basename(path):<32} {s['ipc']:>6.3f} {s['l1d_mpki']:>9.2f} {s['l2_mpki']:>8.2f} "
+                  f"{s['bound']:<8} {format_shares(s['shares']):>29}")
+
+        # What a larger L1D can still buy: the L2 and DRAM shares of the smallest cache
+        first, last = app_runs[0][2], app_runs[-1][2]
+        if len(app_runs) > 1:
+            relieved = (first['shares']['L2'] - last['shares']['L2']) * 100
+            print(f"  From {os.path.basename(app_runs[0][0])} to {os.path.basename(app_runs[-1][0])}: "
+                  f"L2 share {relieved:+.1f} points, DRAM share "
+                  f"{(first['shares']['DRAM'] - last['shares']['DRAM']) * 100:+.1f} points relieved")
+            if last['bound'] == 'DRAM':
+                print("  Still DRAM-bound at the largest L1D: its misses are not ones a larger L1D removes")
+
+def find_runs(paths):
+    """Directories with a stats.txt, searched recursively"""
+    runs = []
+    for path in paths:
+        if os.path.isfile(path):
+            runs.append(os.path.dirname(path) or '.')
+            continue
+        for root, _, files in os.walk(path):
+            if 'stats.txt' in files:
+                runs.append(root)
+    return sorted(runs)
+
+def main():
+    parser = argparse.ArgumentParser(description='Phase detection and bottleneck classification')
+    parser.add_argument('paths', nargs='+', help='Run directories, result trees or stats.txt files')
+    parser.add_argument('--threshold', type=float, default=0.2,
+                       help='Relative IPC change that starts a new phase (default: 0.2)')
+    parser.add_argument('--min-intervals', type=int, default=2,
+                       help='Shorter phases are merged into their predecessor (default: 2)')
+    parser.add_argument('--l1-latency', type=float, default=4,
+                       help='L1D hit latency in cycles (default: 4)')
+    parser.add_argument('--l2-latency', type=float, default=40,
+                       help='L2 hit latency in cycles seen by the CPU (default: 40)')
+    parser.add_argument('--dram-latency', type=float, default=200,
+                       help='DRAM latency in cycles when the memory controller does not report it (default: 200)')
+    parser.add_argument('--summary', action='store_true',
+                       help='Only print the per-run bottleneck summary')
+
+    args = parser.parse_args()
+
+    runs = []
+    for run_path in find_runs(args.paths):
+        dumps = parse_stats_dumps(os.path.join(run_path, 'stats.txt'))
+        intervals = interval_metrics(dumps, args)
+        if not intervals:
+            print(f"Warning: no usable stats dumps in {run_path}")
+            continue
+        if len(intervals) == 1 and not args.summary:
+            print(f"Note: {run_path} has a single dump; rerun with --stats_period for phases")
+
+        if not args.summary:
+            phases = segment_phases(intervals, args.threshold, args.min_intervals)
+            print_phases(run_path, phases, len(intervals))
+        runs.append((run_path, extract_config_from_path(run_path), summarize(intervals)))
+
+    if not runs:
+        print("No simulation results found!")
+        return 1
+
+    if args.summary or len(runs) > 1:
+        print_summary(runs)
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
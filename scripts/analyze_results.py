@@ -4,8 +4,17 @@ import os
 import sys
 import argparse
 import re
+import json
+import math
 from collections import defaultdict
 
+# Build variants produced by kernels/Makefile (keep in sync with VARIANTS there)
+VARIANTS = ['o2', 'o3native', 'lto', 'pgo-gen', 'pgo', 'static']
+
+# Kernel families; kernels are named <family>_<version>, e.g. matrix_mult_ikj_t32
+KERNEL_FAMILIES = ['matrix_mult', 'image_blur', 'hash_ops', 'stream_bench', 'batched_gemm',
+                   'lu_factor', 'cholesky', 'conv2d']
+
 def parse_stats_file(filepath):
     """Parse gem5 stats.txt file and extract relevant metrics"""
     stats = {}
@@ -19,8 +28,13 @@ def parse_stats_file(filepath):
             for line in f:
                 line = line.strip()
                 
-                # Skip comments and empty lines
-                if line.startswith('#') or not line:
+                # Only read the first stats dump: with ROI markers
+                # (-DGEM5_ROI) it covers exactly the measured region
+                if line.startswith('---------- End Simulation Statistics'):
+                    break
+                
+                # Skip comments, dump markers and empty lines
+                if line.startswith('#') or line.startswith('-') or not line:
                     continue
                 
                 # Parse stat lines (format: stat_name value # comment)
@@ -40,6 +54,49 @@ def parse_stats_file(filepath):
     
     return stats
 
+def parse_stats_dumps(filepath):
+    """Parse every stats dump in a gem5 stats.txt file.
+    
+    Returns a list with one {stat name: value} dict per dump, in order.
+    With periodic dumps (cache_experiment.py --stats_period) each dump
+    covers one interval. A file without Begin/End markers (native
+    PERF_STATS_FILE output, hand-written test results) is one dump.
+    """
+    dumps = []
+    current = None
+    unmarked = {}
+    has_markers = False
+    
+    try:
+        with open(filepath, 'r') as f:
+            for line in f:
+                line = line.strip()
+                if line.startswith('---------- Begin Simulation Statistics'):
+                    has_markers = True
+                    current = {}
+                    continue
+                if line.startswith('---------- End Simulation Statistics'):
+                    if current:
+                        dumps.append(current)
+                    current = None
+                    continue
+                if line.startswith('#') or not line:
+                    continue
+                
+                parts = line.split()
+                if len(parts) >= 2:
+                    target = current if current is not None else unmarked
+                    try:
+                        target[parts[0]] = float(parts[1])
+                    except ValueError:
+                        target[parts[0]] = parts[1]
+    except OSError as e:
+        print(f"Error parsing {filepath}: {e}")
+    
+    if not has_markers and unmarked:
+        dumps.append(unmarked)
+    return dumps
+
 def extract_config_from_path(result_path):
     """Extract configuration parameters from result path"""
     config = {}
@@ -57,11 +114,24 @@ def extract_config_from_path(result_path):
     if assoc_match:
         config['associativity'] = int(assoc_match.group(1))
     
+    # Look for L2 sweep suffix (e.g., "L2-512kB-8way")
+    l2_match = re.search(r'L2-(\d+)[kK][bB]-(\d+)way', dirname)
+    if l2_match:
+        config['l2_size'] = l2_match.group(1) + 'kB'
+        config['l2_assoc'] = int(l2_match.group(2))
+    
     # Extract application name from path
     path_parts = result_path.split('/')
     for part in path_parts:
-        if any(app in part for app in ['matrix_mult', 'image_blur', 'hash_ops', 'stream_bench']):
+        family = next((app for app in KERNEL_FAMILIES if app in part), None)
+        if family:
             config['application'] = part
+            config['family'] = family
+            # Makefile builds are labeled <kernel>.<variant>
+            kernel, _, variant = part.partition('.')
+            if variant in VARIANTS:
+                config['kernel'] = kernel
+                config['variant'] = variant
             break
     
     return config
@@ -126,6 +196,203 @@ def get_execution_time(stats):
         return stats['sim_ticks'] * 0.5e-9
     return 0
 
+# Built-in cost models. The coefficients are illustrative, CACTI-like
+# orders of magnitude; pass a JSON file to --cost-model to use real numbers.
+#   area:   mm^2 = size_kB * per_kb * (1 + assoc_factor * log2(assoc)) per level
+#   energy: nJ   = accesses * access_nj * sqrt(size_kB / ref_kb) * (1 + assoc_factor * log2(assoc))
+#                  + DRAM accesses * dram_nj + leakage_mw_per_kb * size_kB * seconds
+# A model may also contain "configs": {"<run dir name>": cost} to override
+# the formula for individual configurations.
+COST_MODELS = {
+    'area': {
+        'type': 'area',
+        'unit': 'mm^2',
+        'l1d_per_kb': 0.025,
+        'l1d_assoc_factor': 0.05,
+        'l2_per_kb': 0.012,
+        'l2_assoc_factor': 0.03,
+    },
+    'energy': {
+        'type': 'energy',
+        'unit': 'nJ',
+        'l1d_access_nj': 0.05,
+        'l1d_ref_kb': 32,
+        'l1d_assoc_factor': 0.15,
+        'l2_access_nj': 0.3,
+        'l2_ref_kb': 256,
+        'l2_assoc_factor': 0.10,
+        'dram_nj': 15.0,
+        'leakage_mw_per_kb': 0.01,
+    },
+}
+
+# Defaults of cache_experiment.py, used when a run does not record its L2 config
+DEFAULT_L2_SIZE_KB = 256
+DEFAULT_L2_ASSOC = 8
+
+def load_cost_model(spec):
+    """Load a built-in cost model by name, or a JSON model from a file.
+    
+    A JSON model with a "base" key inherits from that built-in model, so it
+    only needs to list the coefficients it changes.
+    """
+    if spec in COST_MODELS:
+        model = dict(COST_MODELS[spec])
+        model['name'] = spec
+        return model
+    
+    try:
+        with open(spec, 'r') as f:
+            user_model = json.load(f)
+    except (OSError, ValueError) as e:
+        print(f"Error loading cost model {spec}: {e}")
+        return None
+    
+    model = dict(COST_MODELS.get(user_model.get('base', ''), {}))
+    model.update(user_model)
+    model.setdefault('name', os.path.splitext(os.path.basename(spec))[0])
+    model.setdefault('unit', '')
+    if model.get('type') not in ('area', 'energy') and 'configs' not in model:
+        print(f"Error: cost model {spec} needs a \"type\" (area or energy) or a \"configs\" table")
+        return None
+    return model
+
+def get_cache_params(result):
+    """Return (l1d_kb, l1d_assoc, l2_kb, l2_assoc) for a result"""
+    config = result['config']
+    l1d_kb = int(re.sub(r'[^0-9]', '', config.get('cache_size', '0')) or 0)
+    l1d_assoc = config.get('associativity', 1)
+    l2_kb = int(re.sub(r'[^0-9]', '', config.get('l2_size', '')) or DEFAULT_L2_SIZE_KB)
+    l2_assoc = config.get('l2_assoc', DEFAULT_L2_ASSOC)
+    return l1d_kb, l1d_assoc, l2_kb, l2_assoc
+
+def calculate_cost(result, model):
+    """Calculate the cost of one run's configuration under a cost model"""
+    run_name = os.path.basename(result['path'])
+    if run_name in model.get('configs', {}):
+        return float(model['configs'][run_name])
+    
+    stats = result['stats']
+    l1d_kb, l1d_assoc, l2_kb, l2_assoc = get_cache_params(result)
+    if l1d_kb <= 0:
+        return 0
+    
+    l1d_scale = 1 + model.get('l1d_assoc_factor', 0) * math.log2(max(l1d_assoc, 1))
+    l2_scale = 1 + model.get('l2_assoc_factor', 0) * math.log2(max(l2_assoc, 1))
+    
+    if model.get('type') == 'area':
+        return (l1d_kb * model.get('l1d_per_kb', 0) * l1d_scale +
+                l2_kb * model.get('l2_per_kb', 0) * l2_scale)
+    
+    if model.get('type') == 'energy':
+        l1d_accesses = stats.get('system.cpu.dcache.overall_accesses::total', 0)
+        l2_accesses = stats.get('system.l2cache.overall_accesses::total', 0)
+        dram_accesses = stats.get('system.l2cache.overall_misses::total', 0)
+        l1d_nj = model.get('l1d_access_nj', 0) * math.sqrt(l1d_kb / model.get('l1d_ref_kb', 32)) * l1d_scale
+        l2_nj = model.get('l2_access_nj', 0) * math.sqrt(l2_kb / model.get('l2_ref_kb', 256)) * l2_scale
+        # mW * s = mJ = 1e6 nJ
+        leakage_nj = model.get('leakage_mw_per_kb', 0) * (l1d_kb + l2_kb) * get_execution_time(stats) * 1e6
+        return (l1d_accesses * l1d_nj + l2_accesses * l2_nj +
+                dram_accesses * model.get('dram_nj', 0) + leakage_nj)
+    
+    return 0
+
+def higher_is_better(y_metric):
+    """Whether larger values of a metric mean better performance"""
+    return y_metric == 'ipc'
+
+def pareto_frontier(points, maximize=True):
+    """Return the indices of the Pareto-optimal points.
+    
+    points is a list of (cost, value) pairs; a point is optimal when no other
+    point has lower-or-equal cost and a better-or-equal value (strictly better
+    in at least one). value is maximized, or minimized if maximize is False.
+    """
+    sign = 1 if maximize else -1
+    order = sorted(range(len(points)), key=lambda i: (points[i][0], -sign * points[i][1]))
+    
+    frontier = []
+    best = None
+    for i in order:
+        value = sign * points[i][1]
+        if best is None or value > best:
+            frontier.append(i)
+            best = value
+    return frontier
+
+def collect_cost_points(results, y_metric, model):
+    """Average (cost, metric) per application and configuration.
+    
+    Returns {app_name: [(config_name, cost, value), ...]}.
+    """
+    grouped = defaultdict(lambda: defaultdict(list))
+    for result in results:
+        app_name = result['config'].get('application', 'unknown')
+        config_name = os.path.basename(result['path'])
+        cost = calculate_cost(result, model)
+        value = get_metric_value(result['stats'], y_metric)
+        if cost > 0 and value > 0:
+            grouped[app_name][config_name].append((cost, value))
+    
+    points = {}
+    for app_name, configs in grouped.items():
+        points[app_name] = []
+        for config_name, values in configs.items():
+            cost = sum(v[0] for v in values) / len(values)
+            value = sum(v[1] for v in values) / len(values)
+            points[app_name].append((config_name, cost, value))
+    return points
+
+def get_metric_value(stats, y_metric):
+    """Calculate a Y metric from stats"""
+    if y_metric == 'ipc':
+        return calculate_ipc(stats)
+    elif y_metric == 'l1d_miss_rate':
+        return calculate_miss_rate(stats, 'l1d')
+    elif y_metric == 'l2_miss_rate':
+        return calculate_miss_rate(stats, 'l2')
+    elif y_metric == 'execution_time':
+        return get_execution_time(stats)
+    return 0
+
+def print_pareto_results(results, y_metric, model):
+    """Print every configuration's cost and performance, marking the Pareto frontier"""
+    unit = f" {model['unit']}" if model.get('unit') else ''
+    
+    print(f"\n{'='*70}")
+    print(f"Pareto Analysis: {y_metric} vs {model['name']} cost ({model.get('unit') or 'arbitrary units'})")
+    print(f"{'='*70}")
+    
+    points = collect_cost_points(results, y_metric, model)
+    maximize = higher_is_better(y_metric)
+    
+    for app_name in sorted(points.keys()):
+        app_points = sorted(points[app_name], key=lambda p: p[1])
+        frontier = set(pareto_frontier([(p[1], p[2]) for p in app_points], maximize))
+        
+        print(f"\n{app_name.upper()} RESULTS:")
+        print("-" * 58)
+        print(f"{'Config':<28} {'Cost':<12} {y_metric:<12} {'Pareto':<6}")
+        print("-" * 58)
+        for i, (config_name, cost, value) in enumerate(app_points):
+            mark = '*' if i in frontier else ''
+            print(f"{config_name:<28} {cost:<12.4g} {value:<12.4f} {mark:<6}")
+        
+        print(f"\n  Pareto-optimal configurations: {len(frontier)} of {len(app_points)}")
+        for i in sorted(frontier):
+            config_name, cost, value = app_points[i]
+            print(f"    {config_name}: cost {cost:.4g}{unit}, {y_metric} {value:.4f}")
+
+def config_sort_key(x):
+    """Sort cache sizes and associativities numerically, variants in build order"""
+    if x in VARIANTS:
+        return VARIANTS.index(x)
+    if 'kB' in str(x) or 'KB' in str(x):
+        return int(x.replace('kB', '').replace('KB', ''))
+    if isinstance(x, int):
+        return x
+    return float('inf')
+
 def print_tabular_results(results, x_metric, y_metric):
     """Print results in tabular format"""
     
@@ -147,36 +414,41 @@ def print_tabular_results(results, x_metric, y_metric):
             x_val = config.get('cache_size', 'unknown')
         elif x_metric == 'l1d_assoc':
             x_val = config.get('associativity', 'unknown')
+        elif x_metric == 'variant':
+            # Compare the variants of one kernel side by side
+            app_name = config.get('kernel', app_name)
+            x_val = config.get('variant', 'unknown')
+        elif x_metric == 'kernel':
+            # Rank the kernels of one family (e.g. every matrix_mult loop
+            # order) per cache configuration
+            app_name = f"{config.get('family', app_name)} @ {os.path.basename(result['path'])}"
+            x_val = config.get('application', 'unknown')
         else:
             x_val = 'unknown'
         
         # Calculate Y value
-        if y_metric == 'ipc':
-            y_val = calculate_ipc(stats)
-        elif y_metric == 'l1d_miss_rate':
-            y_val = calculate_miss_rate(stats, 'l1d')
-        elif y_metric == 'l2_miss_rate':
-            y_val = calculate_miss_rate(stats, 'l2')
-        elif y_metric == 'execution_time':
-            y_val = get_execution_time(stats)
-        else:
-            y_val = 0
+        y_val = get_metric_value(stats, y_metric)
         
         grouped[app_name][x_val].append(y_val)
     
+    # Kernel names are longer than cache configurations
+    width = 28 if x_metric == 'kernel' else 12
+    
     # Print results for each application
     for app_name in sorted(grouped.keys()):
         print(f"\n{app_name.upper()} RESULTS:")
-        print("-" * 50)
-        print(f"{'Config':<12} {'Average':<12} {'Min':<12} {'Max':<12} {'Count':<6}")
-        print("-" * 50)
+        print("-" * (width + 38))
+        print(f"{'Config':<{width}} {'Average':<12} {'Min':<12} {'Max':<12} {'Count':<6}")
+        print("-" * (width + 38))
         
-        # Sort configurations
+        # Sort configurations; kernels are ranked best first
         app_configs = grouped[app_name]
-        sorted_configs = sorted(app_configs.keys(), key=lambda x: (
-            int(x.replace('kB', '').replace('KB', '')) if 'kB' in str(x) or 'KB' in str(x) 
-            else float('inf') if x == 'unknown' else int(x)
-        ))
+        if x_metric == 'kernel':
+            sign = -1 if higher_is_better(y_metric) else 1
+            sorted_configs = sorted(app_configs.keys(),
+                                    key=lambda k: sign * sum(app_configs[k]) / len(app_configs[k]))
+        else:
+            sorted_configs = sorted(app_configs.keys(), key=config_sort_key)
         
         for config in sorted_configs:
             values = app_configs[config]
@@ -186,7 +458,7 @@ def print_tabular_results(results, x_metric, y_metric):
                 max_val = max(values)
                 count = len(values)
                 
-                print(f"{str(config):<12} {avg_val:<12.4f} {min_val:<12.4f} {max_val:<12.4f} {count:<6}")
+                print(f"{str(config):<{width}} {avg_val:<12.4f} {min_val:<12.4f} {max_val:<12.4f} {count:<6}")
     
     print(f"\nSUMMARY:")
     print("-" * 50)
@@ -248,12 +520,16 @@ def print_analysis_summary(results):
 def main():
     parser = argparse.ArgumentParser(description='Analyze gem5 simulation results')
     parser.add_argument('results_dir', help='Directory containing simulation results')
-    parser.add_argument('x_metric', choices=['l1d_size', 'l1d_assoc'], 
-                       help='X-axis metric (independent variable)')
+    parser.add_argument('x_metric', choices=['l1d_size', 'l1d_assoc', 'variant', 'kernel', 'cost'], 
+                       help='X-axis metric (independent variable); "variant" compares build variants, '
+                            '"kernel" ranks the kernels of a family per configuration, '
+                            '"cost" runs a Pareto analysis')
     parser.add_argument('y_metric', choices=['ipc', 'l1d_miss_rate', 'l2_miss_rate', 'execution_time'],
                        help='Y-axis metric (dependent variable)')
     parser.add_argument('--summary', action='store_true', 
                        help='Print analysis summary in addition to tabular results')
+    parser.add_argument('--cost-model', default='area',
+                       help='Cost model for x_metric "cost": area, energy, or a JSON file (default: area)')
     
     args = parser.parse_args()
     
@@ -273,7 +549,13 @@ def main():
         return 1
     
     # Print tabular analysis
-    print_tabular_results(results, args.x_metric, args.y_metric)
+    if args.x_metric == 'cost':
+        model = load_cost_model(args.cost_model)
+        if model is None:
+            return 1
+        print_pareto_results(results, args.y_metric, model)
+    else:
+        print_tabular_results(results, args.x_metric, args.y_metric)
     
     # Print summary analysis if requested
     if args.summary:
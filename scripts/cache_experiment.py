@@ -21,6 +21,18 @@ SimpleOpts.add_option("--l2_size", default="256kB", help="L2 cache size")
 SimpleOpts.add_option("--l2_assoc", default="8", help="L2 cache associativity")
 SimpleOpts.add_option("--binary", required=True, help="Binary to run")
 SimpleOpts.add_option("--out_dir", default="m5out", help="Output directory")
+SimpleOpts.add_option("--warmup", default="0",
+                      help="Untimed kernel iterations before the measured ones (kernels/harness.h)")
+SimpleOpts.add_option("--repeat", default="1", help="Measured kernel iterations (kernels/harness.h)")
+SimpleOpts.add_option("--stats_period", default="0",
+                      help="Dump and reset statistics every N ticks for phase analysis (0 = off)")
+SimpleOpts.add_option("--prefetcher", default="none", choices=["none", "stride", "tagged"],
+                      help="Hardware prefetcher on the L1D and L2 caches")
+SimpleOpts.add_option("--num_cpus", default="1",
+                      help="CPUs, each with private L1 caches in front of the shared L2 "
+                           "(for multithreaded binaries such as loaded_latency)")
+SimpleOpts.add_option("--kernel_args", default="",
+                      help="Extra kernel arguments, e.g. --kernel_args=--prefetch-sweep")
 
 # Custom cache classes
 class L1Cache(Cache):
@@ -47,7 +59,7 @@ class L2Cache(Cache):
     mshrs = 20
     tgts_per_mshr = 12
 
-def create_system():
+def create_system(num_cpus=1):
     # Create the system
     system = System()
     
@@ -60,16 +72,10 @@ def create_system():
     system.mem_mode = "timing"
     system.mem_ranges = [AddrRange("512MB")]
     
-    # Create a simple timing CPU
-    system.cpu = TimingSimpleCPU()
-    
-    # Create L1 caches
-    system.cpu.icache = L1ICache()
-    system.cpu.dcache = L1DCache()
-    
-    # Connect CPU to L1 caches
-    system.cpu.icache.cpu_side = system.cpu.icache_port
-    system.cpu.dcache.cpu_side = system.cpu.dcache_port
+    # Create simple timing CPUs; a single one stays system.cpu, the stat
+    # prefix the analysis scripts read (several become system.cpu0, ...)
+    cpus = [TimingSimpleCPU(cpu_id=i) for i in range(num_cpus)]
+    system.cpu = cpus[0] if num_cpus == 1 else cpus
     
     # Create L2 cache
     system.l2cache = L2Cache()
@@ -77,25 +83,34 @@ def create_system():
     # Create L2 bus
     system.l2bus = L2XBar()
     
-    # Connect L1 caches to L2 bus
-    system.cpu.icache.mem_side = system.l2bus.cpu_side_ports
-    system.cpu.dcache.mem_side = system.l2bus.cpu_side_ports
+    # Create system bus
+    system.membus = SystemXBar()
+    
+    for cpu in cpus:
+        # Create L1 caches
+        cpu.icache = L1ICache()
+        cpu.dcache = L1DCache()
+        
+        # Connect CPU to L1 caches
+        cpu.icache.cpu_side = cpu.icache_port
+        cpu.dcache.cpu_side = cpu.dcache_port
+        
+        # Connect L1 caches to L2 bus
+        cpu.icache.mem_side = system.l2bus.cpu_side_ports
+        cpu.dcache.mem_side = system.l2bus.cpu_side_ports
+        
+        # Connect CPU interrupt ports (needed for TimingSimpleCPU)
+        cpu.createInterruptController()
+        cpu.interrupts[0].pio = system.membus.mem_side_ports
+        cpu.interrupts[0].int_requestor = system.membus.cpu_side_ports
+        cpu.interrupts[0].int_responder = system.membus.mem_side_ports
     
     # Connect L2 cache to L2 bus
     system.l2cache.cpu_side = system.l2bus.mem_side_ports
     
-    # Create system bus
-    system.membus = SystemXBar()
-    
     # Connect L2 cache to memory bus
     system.l2cache.mem_side = system.membus.cpu_side_ports
     
-    # Connect CPU interrupt ports (needed for TimingSimpleCPU)
-    system.cpu.createInterruptController()
-    system.cpu.interrupts[0].pio = system.membus.mem_side_ports
-    system.cpu.interrupts[0].int_requestor = system.membus.cpu_side_ports
-    system.cpu.interrupts[0].int_responder = system.membus.mem_side_ports
-    
     # Create memory controller
     system.mem_ctrl = MemCtrl()
     system.mem_ctrl.dram = DDR3_1600_8x8()
@@ -111,24 +126,39 @@ def main():
     args = SimpleOpts.parse_args()
     
     # Create the system
-    system = create_system()
+    num_cpus = int(args.num_cpus)
+    system = create_system(num_cpus)
+    cpus = [system.cpu] if num_cpus == 1 else list(system.cpu)
     
     # Configure cache sizes based on command line arguments
-    system.cpu.icache.size = args.l1i_size
-    system.cpu.icache.assoc = int(args.l1i_assoc)
-    system.cpu.dcache.size = args.l1d_size
-    system.cpu.dcache.assoc = int(args.l1d_assoc)
+    for cpu in cpus:
+        cpu.icache.size = args.l1i_size
+        cpu.icache.assoc = int(args.l1i_assoc)
+        cpu.dcache.size = args.l1d_size
+        cpu.dcache.assoc = int(args.l1d_assoc)
     system.l2cache.size = args.l2_size
     system.l2cache.assoc = int(args.l2_assoc)
     
+    # Hardware prefetchers share the caches' MSHRs (4 on the L1D) with demand
+    # misses and software prefetches
+    prefetchers = {"stride": StridePrefetcher, "tagged": TaggedPrefetcher}
+    if args.prefetcher in prefetchers:
+        for cpu in cpus:
+            cpu.dcache.prefetcher = prefetchers[args.prefetcher]()
+        system.l2cache.prefetcher = prefetchers[args.prefetcher]()
+    
     # Set up the workload
     system.workload = SEWorkload.init_compatible(args.binary)
     
     # Set up the process
     process = Process()
-    process.cmd = [args.binary]
-    system.cpu.workload = process
-    system.cpu.createThreads()
+    # With ROI markers (-DGEM5_ROI) the harness resets the stats after the
+    # warm-up iterations, so the first dump shows the steady state
+    process.cmd = [args.binary, "--warmup", args.warmup, "--repeat", args.repeat] + args.kernel_args.split()
+    # Threads the process creates start on the idle CPUs
+    for cpu in cpus:
+        cpu.workload = process
+        cpu.createThreads()
     
     # Create the root object
     root = Root(full_system=False, system=system)
@@ -136,11 +166,19 @@ def main():
     # Instantiate the simulation
     m5.instantiate()
     
+    # Periodic dumps give stats.txt one block per interval (see analyze_phases.py)
+    if int(args.stats_period) > 0:
+        m5.stats.periodicStatDump(int(args.stats_period))
+    
     print(f"Beginning simulation with:")
     print(f"  L1D Cache: {args.l1d_size}, {args.l1d_assoc}-way")
     print(f"  L1I Cache: {args.l1i_size}, {args.l1i_assoc}-way") 
     print(f"  L2 Cache: {args.l2_size}, {args.l2_assoc}-way")
-    print(f"  Binary: {args.binary}")
+    print(f"  CPUs: {num_cpus}")
+    print(f"  Prefetcher: {args.prefetcher}")
+    print(f"  Binary: {args.binary} (--warmup {args.warmup} --repeat {args.repeat} {args.kernel_args})")
+    if int(args.stats_period) > 0:
+        print(f"  Stats dumped every {args.stats_period} ticks")
     
     # Run the simulation
     exit_event = m5.simulate()
@@ -0,0 +1,353 @@
+#!/usr/bin/env python3
+
+"""
+Native versus simulated correlation report.
+
+Joins the native perf-counter runs of run_native.sh with the gem5 runs of
+run_cache_sweep.sh for the same kernels and reports whether the gem5 model
+ranks them the way the real hardware does:
+
+  - Per kernel: L1D and L2/LLC miss rates, IPC and the speedup over the
+    family baseline (e.g. matrix_mult_unopt.o2 for matrix_mult_*), natively
+    and simulated.
+  - Pearson and Spearman correlation of miss rates and speedups.
+  - Per kernel family, the fraction of pairs that gem5 orders like the
+    hardware, and the pairs it orders the other way.
+  - Flags where TimingSimpleCPU misleads: it executes one instruction at a
+    time without overlap and the modelled caches have no prefetcher, so it
+    misses speedups that come from IPC (ILP, SIMD, memory-level parallelism)
+    and overstates those that come from removing misses the hardware hides.
+"""
+
+import os
+import sys
+import math
+import argparse
+import itertools
+from collections import defaultdict
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, SCRIPT_DIR)
+
+from analyze_results import (VARIANTS, KERNEL_FAMILIES, collect_results, calculate_miss_rate,
+                             get_execution_time)
+
+def kernel_key(config, ignore_variant):
+    """Name a result is joined on: <kernel>.<variant>, or the kernel alone"""
+    application = config.get('application', 'unknown')
+    if ignore_variant:
+        return config.get('kernel', application)
+    return application
+
+def kernel_family(key):
+    """matrix_mult_unopt.o2 and matrix_mult_ikj_t32.lto both belong to matrix_mult"""
+    kernel = key.partition('.')[0]
+    return next((family for family in KERNEL_FAMILIES if kernel.startswith(family)), kernel)
+
+def summarize_runs(results):
+    """Average the metrics of repeated runs of one kernel"""
+    metrics = defaultdict(list)
+    for result in results:
+        stats = result['stats']
+        metrics['time'].append(get_execution_time(stats))
+        metrics['insts'].append(stats.get('sim_insts', 0))
+        if 'system.cpu.dcache.overall_accesses::total' in stats:
+            metrics['l1d_miss_rate'].append(calculate_miss_rate(stats, 'l1d'))
+        if 'system.l2cache.overall_accesses::total' in stats:
+            metrics['l2_miss_rate'].append(calculate_miss_rate(stats, 'l2'))
+    summary = {name: sum(values) / len(values) for name, values in metrics.items() if values}
+    summary['runs'] = len(results)
+    return summary
+
+def collect_native(native_dir, ignore_variant):
+    """Native runs, averaged per kernel"""
+    by_key = defaultdict(list)
+    for result in collect_results(native_dir):
+        by_key[kernel_key(result['config'], ignore_variant)].append(result)
+    return {key: summarize_runs(results) for key, results in by_key.items()}
+
+def collect_simulated(sim_dir, native_dir, config_name, ignore_variant):
+    """gem5 runs of one cache configuration, per kernel"""
+    native_root = os.path.abspath(native_dir)
+    by_config = defaultdict(lambda: defaultdict(list))
+    for result in collect_results(sim_dir):
+        path = os.path.abspath(result['path'])
+        if path == native_root or path.startswith(native_root + os.sep):
+            continue
+        key = kernel_key(result['config'], ignore_variant)
+        by_config[os.path.basename(result['path'])][key].append(result)
+
+    if not by_config:
+        return None, {}
+    if config_name is None:
+        # The configuration most kernels were simulated with
+        config_name = max(sorted(by_config), key=lambda name: len(by_config[name]))
+    elif config_name not in by_config:
+        return config_name, {}
+    runs = by_config[config_name]
+    return config_name, {key: summarize_runs(results) for key, results in runs.items()}
+
+def pick_baseline(keys, requested):
+    """Family baseline: --baseline if given, else the unoptimized source in the first variant"""
+    for key in keys:
+        if key in requested:
+            return key
+
+    def rank(key):
+        kernel, _, variant = key.partition('.')
+        return (not kernel.endswith('_unopt'),
+                VARIANTS.index(variant) if variant in VARIANTS else -1,
+                key)
+    return min(keys, key=rank)
+
+def ipc(summary):
+    """Instructions per second; comparable within one side of the join"""
+    if summary.get('time', 0) > 0:
+        return summary.get('insts', 0) / summary['time']
+    return 0
+
+def pearson(xs, ys):
+    n = len(xs)
+    if n < 2:
+        return None
+    mean_x = sum(xs) / n
+    mean_y = sum(ys) / n
+    cov = sum((x - mean_x) * (y - mean_y) for x, y in zip(xs, ys))
+    var_x = sum((x - mean_x) ** 2 for x in xs)
+    var_y = sum((y - mean_y) ** 2 for y in ys)
+    if var_x == 0 or var_y == 0:
+        return None
+    return cov / math.sqrt(var_x * var_y)
+
+def ranks(values):
+    """Ranks with ties sharing their average rank"""
+    order = sorted(range(len(values)), key=lambda i: values[i])
+    result = [0.0] * len(values)
+    i = 0
+    while i < len(order):
+        j = i
+        while j + 1 < len(order) and values[order[j + 1]] == values[order[i]]:
+            j += 1
+        for k in range(i, j + 1):
+            result[order[k]] = (i + j) / 2
+        i = j + 1
+    return result
+
+def spearman(xs, ys):
+    return pearson(ranks(xs), ranks(ys))
+
+def build_rows(native, simulated, requested_baselines):
+    """Joined kernels with speedups over their family baseline"""
+    common = sorted(set(native) & set(simulated))
+    families = defaultdict(list)
+    for key in common:
+        families[kernel_family(key)].append(key)
+
+    rows = []
+    for family in sorted(families):
+        keys = families[family]
+        baseline = pick_baseline(keys, requested_baselines)
+        for key in sorted(keys, key=lambda key: key != baseline):
+            row = {'key': key, 'family': family, 'baseline': baseline,
+                   'native': native[key], 'sim': simulated[key]}
+            for side in ('native', 'sim'):
+                base = (native if side == 'native' else simulated)[baseline]
+                this = row[side]
+                row[side + '_speedup'] = base['time'] / this['time'] if this.get('time') else 0
+                # Speedup = instruction ratio x IPC ratio; keep the IPC part
+                if this.get('insts') and base.get('insts') and ipc(base) > 0:
+                    row[side + '_ipc_gain'] = ipc(this) / ipc(base)
+            rows.append(row)
+    return rows
+
+def format_rate(summary, name):
+    return f"{summary[name] * 100:.2f}%" if name in summary else "-"
+
+def print_table(rows):
+    print(f"\n{'Kernel':<30} {'L1D miss':>17} {'L2/LLC miss':>17} {'Speedup':>15}")
+    print(f"{'':<30} {'native':>8} {'gem5':>8} {'native':>8} {'gem5':>8} {'native':>7} {'gem5':>7}")
+    print("-" * 82)
+    family = None
+    for row in rows:
+        if row['family'] != family:
+            family = row['family']
+            print(f"{family} (baseline {row['baseline']})")
+        print(f"  {row['key']:<28} "
+              f"{format_rate(row['native'], 'l1d_miss_rate'):>8} {format_rate(row['sim'], 'l1d_miss_rate'):>8} "
+              f"{format_rate(row['native'], 'l2_miss_rate'):>8} {format_rate(row['sim'], 'l2_miss_rate'):>8} "
+              f"{row['native_speedup']:>6.2f}x {row['sim_speedup']:>6.2f}x")
+
+def print_correlations(rows):
+    print(f"\nCorrelation across {len(rows)} kernels:")
+    print(f"{'Metric':<18} {'Pearson':>8} {'Spearman':>9} {'Pairs':>6}")
+    print("-" * 44)
+    for label, getter in (
+            ('L1D miss rate', lambda row, side: row[side].get('l1d_miss_rate')),
+            ('L2/LLC miss rate', lambda row, side: row[side].get('l2_miss_rate')),
+            ('Speedup', lambda row, side: row[side + '_speedup'])):
+        pairs = [(getter(row, 'native'), getter(row, 'sim')) for row in rows]
+        pairs = [(x, y) for x, y in pairs if x is not None and y is not None]
+        xs = [x for x, _ in pairs]
+        ys = [y for _, y in pairs]
+        r = pearson(xs, ys)
+        rho = spearman(xs, ys)
+        print(f"{label:<18} {r if r is not None else float('nan'):>8.3f} "
+              f"{rho if rho is not None else float('nan'):>9.3f} {len(pairs):>6}")
+    print("Native counters count L1D/LLC reads only and the LLC stands in for gem5's L2,")
+    print("so compare trends rather than absolute miss rates.")
+
+def ranking_agreement(rows, noise):
+    """Per family: concordant pair count, pair count and the discordant pairs.
+    Pairs whose native speedups differ by less than noise are not ranked."""
+    by_family = defaultdict(list)
+    for row in rows:
+        by_family[row['family']].append(row)
+
+    agreement = {}
+    for family, family_rows in sorted(by_family.items()):
+        concordant = 0
+        discordant = []
+        pairs = 0
+        for a, b in itertools.combinations(family_rows, 2):
+            native_diff = a['native_speedup'] - b['native_speedup']
+            sim_diff = a['sim_speedup'] - b['sim_speedup']
+            if abs(native_diff) <= noise * min(a['native_speedup'], b['native_speedup']):
+                continue
+            pairs += 1
+            if native_diff * sim_diff > 0:
+                concordant += 1
+            else:
+                # Native order: faster one first
+                faster, slower = (a, b) if native_diff > 0 else (b, a)
+                discordant.append((faster, slower))
+        agreement[family] = (concordant, pairs, discordant)
+    return agreement
+
+def print_ranking(agreement):
+    print("\nSpeedup ranking agreement (pairs gem5 orders like the hardware):")
+    print("-" * 60)
+    for family, (concordant, pairs, discordant) in agreement.items():
+        if pairs == 0:
+            print(f"  {family:<24} (needs two kernels with different native speed)")
+            continue
+        print(f"  {family:<24} {concordant}/{pairs} ({concordant / pairs * 100:.0f}%)")
+        for faster, slower in discordant:
+            print(f"    native: {faster['key']} {faster['native_speedup'] / slower['native_speedup']:.2f}x faster "
+                  f"than {slower['key']}; gem5: {slower['sim_speedup'] / faster['sim_speedup']:.2f}x slower")
+
+def misleading(row, tolerance, noise):
+    """Reasons gem5's speedup for this kernel should not be trusted"""
+    reasons = []
+    if row['key'] == row['baseline'] or not row['native_speedup'] or not row['sim_speedup']:
+        return reasons
+    ratio = row['sim_speedup'] / row['native_speedup']
+    native_ipc_gain = row.get('native_ipc_gain')
+    sim_ipc_gain = row.get('sim_ipc_gain')
+
+    if ratio < 1 / (1 + tolerance):
+        if native_ipc_gain and native_ipc_gain > 1 + tolerance and \
+                (sim_ipc_gain is None or sim_ipc_gain < native_ipc_gain / (1 + tolerance)):
+            reasons.append(f"gem5 underestimates the speedup ({row['sim_speedup']:.2f}x vs "
+                           f"{row['native_speedup']:.2f}x): the hardware gains {native_ipc_gain:.2f}x IPC "
+                           f"(ILP, SIMD, overlapped misses) that the in-order TimingSimpleCPU cannot show")
+        else:
+            reasons.append(f"gem5 underestimates the speedup ({row['sim_speedup']:.2f}x vs "
+                           f"{row['native_speedup']:.2f}x)")
+    elif ratio > 1 + tolerance:
+        if sim_ipc_gain and sim_ipc_gain > 1 + tolerance:
+            reasons.append(f"gem5 overestimates the speedup ({row['sim_speedup']:.2f}x vs "
+                           f"{row['native_speedup']:.2f}x): it gains {sim_ipc_gain:.2f}x IPC from fewer "
+                           f"misses, which the hardware largely hides (out-of-order execution, prefetching)")
+        else:
+            reasons.append(f"gem5 overestimates the speedup ({row['sim_speedup']:.2f}x vs "
+                           f"{row['native_speedup']:.2f}x)")
+    if row['native_speedup'] > 1 + noise and row['sim_speedup'] < 1:
+        reasons.append("gem5 reports a slowdown where the hardware speeds up")
+    elif row['native_speedup'] < 1 - noise and row['sim_speedup'] > 1:
+        reasons.append("gem5 reports a speedup where the hardware slows down")
+    return reasons
+
+def miss_trend_mismatch(row, rows_by_key, tolerance):
+    """L1D miss rate moves in opposite directions relative to the baseline"""
+    base = rows_by_key[row['baseline']]
+    deltas = []
+    for side in ('native', 'sim'):
+        this = row[side].get('l1d_miss_rate')
+        ref = base[side].get('l1d_miss_rate')
+        if this is None or not ref:
+            return None
+        deltas.append(this / ref - 1)
+    native_delta, sim_delta = deltas
+    if abs(native_delta) > tolerance and abs(sim_delta) > tolerance and native_delta * sim_delta < 0:
+        return (f"L1D miss rate changes {native_delta * 100:+.0f}% natively but "
+                f"{sim_delta * 100:+.0f}% in gem5 (access pattern or prefetcher effect not modelled)")
+    return None
+
+def print_flags(rows, tolerance, noise):
+    rows_by_key = {row['key']: row for row in rows}
+    print(f"\nWhere the TimingSimpleCPU model misleads (tolerance {tolerance * 100:.0f}%):")
+    print("-" * 60)
+    flagged = 0
+    for row in rows:
+        reasons = misleading(row, tolerance, noise)
+        if row['key'] != row['baseline']:
+            trend = miss_trend_mismatch(row, rows_by_key, tolerance)
+            if trend:
+                reasons.append(trend)
+        if reasons:
+            flagged += 1
+            print(f"  {row['key']}:")
+            for reason in reasons:
+                print(f"    - {reason}")
+    if not flagged:
+        print("  Nothing flagged: gem5 speedups are within tolerance of the native ones")
+
+def main():
+    parser = argparse.ArgumentParser(description='Correlate native perf-counter runs with gem5 runs')
+    parser.add_argument('native_dir', help='Native results (run_native.sh), e.g. results/native')
+    parser.add_argument('sim_dir', help='gem5 results (run_cache_sweep.sh), e.g. results')
+    parser.add_argument('--config', help='gem5 run directory name to compare, e.g. 64kB_assoc2 '
+                                         '(default: the configuration most kernels were run with)')
+    parser.add_argument('--ignore-variant', action='store_true',
+                       help='Join on the kernel name only, e.g. native o2 builds with gem5 static builds')
+    parser.add_argument('--baseline', action='append', default=[],
+                       help='Baseline kernel of its family, repeatable (default: the _unopt kernel)')
+    parser.add_argument('--tolerance', type=float, default=0.25,
+                       help='Relative speedup difference that is flagged (default: 0.25)')
+    parser.add_argument('--noise', type=float, default=0.03,
+                       help='Native speed differences below this are not ranked (default: 0.03)')
+
+    args = parser.parse_args()
+
+    native = collect_native(args.native_dir, args.ignore_variant)
+    if not native:
+        print(f"No native results found in {args.native_dir}")
+        return 1
+    config_name, simulated = collect_simulated(args.sim_dir, args.native_dir, args.config,
+                                               args.ignore_variant)
+    if not simulated:
+        print(f"No gem5 results found in {args.sim_dir}" +
+              (f" for configuration {config_name}" if config_name else ""))
+        return 1
+
+    rows = build_rows(native, simulated, set(args.baseline))
+    unmatched = sorted(set(native) ^ set(simulated))
+
+    print(f"\n{'='*70}")
+    print(f"Native vs gem5 ({config_name}): {len(rows)} kernels")
+    print(f"{'='*70}")
+    if unmatched:
+        print(f"Only on one side (not compared): {', '.join(unmatched)}")
+        if not args.ignore_variant:
+            print("Use --ignore-variant to join builds of different variants")
+    if not rows:
+        return 1
+
+    print_table(rows)
+    print_correlations(rows)
+    print_ranking(ranking_agreement(rows, args.noise))
+    print_flags(rows, args.tolerance, args.noise)
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
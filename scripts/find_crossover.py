@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+
+"""
+Crossover size between two kernels.
+
+Runs a candidate kernel and a baseline kernel natively at increasing problem
+sizes and reports the size from which the candidate is faster, e.g. where
+matrix_mult_strassen overtakes the blocked classical matrix_mult_ikj_t32.
+Both binaries are harness kernels; each size takes the best time of the
+timed repeats, and a size only counts as a crossover if the candidate also
+wins at every larger size measured.
+"""
+
+import os
+import sys
+import json
+import argparse
+import tempfile
+import subprocess
+
+def best_time(binary, size, warmup, repeats, tmp_dir):
+    """Best wall-clock time of one kernel at one size, or None if it failed
+    or its result did not match the reference"""
+    json_path = os.path.join(tmp_dir, 'result.json')
+    cmd = [binary, '--size', str(size), '--warmup', str(warmup),
+           '--repeat', str(repeats), '--json', json_path]
+    result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    if not os.path.exists(json_path):
+        print(f"ERROR {binary} size {size}: exit code {result.returncode}")
+        print(result.stdout.rstrip())
+        return None
+    with open(json_path) as f:
+        data = json.load(f)
+    os.remove(json_path)
+    # The harness exits with 1 after writing its JSON when the checksum
+    # does not match; the time of a wrong result is no basis for a crossover
+    if data.get('verification') == 'MISMATCH':
+        print(f"WARNING {binary} size {size}: checksum mismatch, size excluded")
+        return None
+    if result.returncode != 0:
+        print(f"ERROR {binary} size {size}: exit code {result.returncode}")
+        print(result.stdout.rstrip())
+        return None
+    return data['best_s']
+
+def find_crossover(rows):
+    """Smallest size from which the candidate wins at every larger size"""
+    crossover = None
+    for size, candidate, baseline in reversed(rows):
+        if candidate >= baseline:
+            break
+        crossover = size
+    return crossover
+
+def main():
+    parser = argparse.ArgumentParser(description='Find the size at which one kernel overtakes another')
+    parser.add_argument('candidate', help='Kernel binary expected to win at large sizes')
+    parser.add_argument('baseline', help='Kernel binary it is compared against')
+    parser.add_argument('--sizes', type=int, nargs='+',
+                       default=[64, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048],
+                       help='Problem sizes, in increasing order (default: 64 to 2048)')
+    parser.add_argument('--warmup', type=int, default=1,
+                       help='Untimed iterations per run (default: 1)')
+    parser.add_argument('--repeat', type=int, default=3,
+                       help='Timed iterations per run (default: 3)')
+
+    args = parser.parse_args()
+
+    for binary in (args.candidate, args.baseline):
+        if not os.path.exists(binary):
+            parser.error(f"binary not found: {binary}")
+
+    candidate_name = os.path.basename(args.candidate)
+    baseline_name = os.path.basename(args.baseline)
+
+    print("=" * 70)
+    print(f"CROSSOVER: {candidate_name} vs {baseline_name}")
+    print("=" * 70)
+    print(f"{'Size':>6} {candidate_name[:20] + ' (s)':>24} {baseline_name[:20] + ' (s)':>24} {'Speedup':>9}")
+    print("-" * 70)
+
+    rows = []
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        for size in sorted(args.sizes):
+            candidate = best_time(args.candidate, size, args.warmup, args.repeat, tmp_dir)
+            baseline = best_time(args.baseline, size, args.warmup, args.repeat, tmp_dir)
+            if candidate is None or baseline is None:
+                continue
+            rows.append((size, candidate, baseline))
+            print(f"{size:>6} {candidate:>24.6f} {baseline:>24.6f} {baseline / candidate:>8.2f}x")
+
+    if not rows:
+        print("No sizes measured")
+        return 1
+
+    print()
+    crossover = find_crossover(rows)
+    if crossover is None:
+        print(f"{candidate_name} is not faster at the largest size measured ({rows[-1][0]})")
+    elif crossover == rows[0][0]:
+        print(f"{candidate_name} is faster at every size measured (from {crossover}); "
+              f"try smaller sizes")
+    else:
+        print(f"Crossover: {candidate_name} is faster from size {crossover} on")
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,289 @@
+#!/usr/bin/env python3
+
+"""
+Generate a self-contained HTML report for a sweep directory.
+
+The report is a single static file: tables, SVG charts, per-run manifests
+and a cross-application comparison are all embedded, so it can be opened
+and archived without a server, network access or matplotlib.
+"""
+
+import os
+import sys
+import json
+import html
+import math
+import argparse
+from datetime import datetime, timezone
+from collections import defaultdict
+
+from analyze_results import (collect_results, calculate_ipc, calculate_miss_rate,
+                             get_execution_time)
+
+METRICS = [
+    ('ipc', 'IPC', lambda s: calculate_ipc(s)),
+    ('l1d_miss_rate', 'L1D miss rate', lambda s: calculate_miss_rate(s, 'l1d')),
+    ('l2_miss_rate', 'L2 miss rate', lambda s: calculate_miss_rate(s, 'l2')),
+    ('execution_time', 'Execution time (s)', lambda s: get_execution_time(s)),
+]
+
+COLORS = ['#1f77b4', '#d62728', '#2ca02c', '#ff7f0e', '#9467bd', '#8c564b', '#17becf']
+
+# IPC spread above which an application is reported as cache-sensitive
+SENSITIVITY_THRESHOLD = 0.10
+
+STYLE = """
+body { font-family: sans-serif; margin: 2em; color: #222; }
+h1, h2, h3 { font-weight: normal; }
+table { border-collapse: collapse; margin: 0.5em 0 1.5em 0; }
+th, td { border: 1px solid #ccc; padding: 3px 8px; text-align: right; }
+th { background: #f0f0f0; }
+td.name { text-align: left; }
+tr.best td { background: #e6f4e6; }
+pre { background: #f7f7f7; padding: 0.5em; font-size: 90%; }
+.charts svg { margin-right: 1em; }
+.meta { color: #666; }
+"""
+
+def size_kb(size):
+    """Convert a size string such as '32kB' to kB (0 if unknown)"""
+    try:
+        return int(str(size).lower().replace('kb', ''))
+    except ValueError:
+        return 0
+
+def load_manifest(run_path):
+    """Load the manifest.json written by run_cache_sweep.sh, if any"""
+    manifest_path = os.path.join(run_path, 'manifest.json')
+    if not os.path.exists(manifest_path):
+        return None
+    try:
+        with open(manifest_path, 'r') as f:
+            return json.load(f)
+    except (OSError, ValueError) as e:
+        print(f"Warning: Could not read manifest {manifest_path}: {e}")
+        return None
+
+def build_rows(results, results_dir):
+    """Flatten results into one row per run with all metrics computed"""
+    rows = []
+    for result in results:
+        config = result['config']
+        manifest = load_manifest(result['path'])
+        row = {
+            'run': os.path.relpath(result['path'], results_dir),
+            'application': config.get('application') or
+                           (manifest or {}).get('application', 'unknown'),
+            'l1d_size': config.get('cache_size', 'unknown'),
+            'l1d_assoc': config.get('associativity', 0),
+            'l2_size': config.get('l2_size') or (manifest or {}).get('l2_size', ''),
+            'l2_assoc': config.get('l2_assoc') or (manifest or {}).get('l2_assoc', ''),
+            'manifest': manifest,
+        }
+        for key, _, func in METRICS:
+            row[key] = func(result['stats'])
+        rows.append(row)
+
+    rows.sort(key=lambda r: (r['application'], size_kb(r['l2_size']), str(r['l2_assoc']),
+                             size_kb(r['l1d_size']), r['l1d_assoc']))
+    return rows
+
+def svg_line_chart(series, title, x_label, y_label, width=460, height=300):
+    """Render {name: [(x, y), ...]} as an inline SVG line chart (log2 X axis)"""
+    points = [(x, y) for values in series.values() for x, y in values if x > 0]
+    if not points:
+        return ''
+
+    left, right, top, bottom = 60, 110, 30, 45
+    plot_w = width - left - right
+    plot_h = height - top - bottom
+
+    xs = sorted(set(math.log2(x) for x, _ in points))
+    x_min, x_max = xs[0], xs[-1]
+    if x_max == x_min:
+        x_min, x_max = x_min - 1, x_max + 1
+    y_min = min(0.0, min(y for _, y in points))
+    y_max = max(y for _, y in points)
+    if y_max == y_min:
+        y_max = y_min + 1
+
+    def px(x):
+        return left + (math.log2(x) - x_min) / (x_max - x_min) * plot_w
+
+    def py(y):
+        return top + plot_h - (y - y_min) / (y_max - y_min) * plot_h
+
+    parts = [f'<svg xmlns="http://www.w3.org/2000/svg" width="{width}" height="{height}" '
+             f'font-size="11" font-family="sans-serif">']
+    parts.append(f'<text x="{width / 2:.0f}" y="16" text-anchor="middle" font-size="13">'
+                 f'{html.escape(title)}</text>')
+    parts.append(f'<rect x="{left}" y="{top}" width="{plot_w}" height="{plot_h}" '
+                 f'fill="none" stroke="#888"/>')
+
+    # Y grid and tick labels
+    for i in range(5):
+        y_val = y_min + (y_max - y_min) * i / 4
+        y_pos = py(y_val)
+        parts.append(f'<line x1="{left}" y1="{y_pos:.1f}" x2="{left + plot_w}" y2="{y_pos:.1f}" '
+                     f'stroke="#ddd"/>')
+        parts.append(f'<text x="{left - 5}" y="{y_pos + 4:.1f}" text-anchor="end">{y_val:.3g}</text>')
+
+    # X tick labels at every swept value
+    for x_log in xs:
+        x_val = 2 ** x_log
+        x_pos = px(x_val)
+        parts.append(f'<text x="{x_pos:.1f}" y="{top + plot_h + 15}" text-anchor="middle">'
+                     f'{x_val:g}</text>')
+
+    parts.append(f'<text x="{left + plot_w / 2:.0f}" y="{height - 8}" text-anchor="middle">'
+                 f'{html.escape(x_label)}</text>')
+    parts.append(f'<text x="14" y="{top + plot_h / 2:.0f}" text-anchor="middle" '
+                 f'transform="rotate(-90 14 {top + plot_h / 2:.0f})">{html.escape(y_label)}</text>')
+
+    for i, (name, values) in enumerate(sorted(series.items())):
+        color = COLORS[i % len(COLORS)]
+        values = sorted(v for v in values if v[0] > 0)
+        coords = ' '.join(f'{px(x):.1f},{py(y):.1f}' for x, y in values)
+        parts.append(f'<polyline points="{coords}" fill="none" stroke="{color}" stroke-width="2"/>')
+        for x, y in values:
+            parts.append(f'<circle cx="{px(x):.1f}" cy="{py(y):.1f}" r="3" fill="{color}">'
+                         f'<title>{html.escape(name)}: {x:g} -&gt; {y:.4g}</title></circle>')
+        legend_y = top + 12 + i * 16
+        parts.append(f'<rect x="{left + plot_w + 10}" y="{legend_y - 8}" width="10" height="10" '
+                     f'fill="{color}"/>')
+        parts.append(f'<text x="{left + plot_w + 24}" y="{legend_y + 1}">{html.escape(name)}</text>')
+
+    parts.append('</svg>')
+    return '\n'.join(parts)
+
+def series_for(rows, metric):
+    """One series per (L1D assoc, L2 config) combination, X = L1D size in kB"""
+    series = defaultdict(list)
+    for row in rows:
+        name = f"assoc {row['l1d_assoc']}"
+        if row['l2_size']:
+            name += f", L2 {row['l2_size']}"
+        if row[metric] > 0:
+            series[name].append((size_kb(row['l1d_size']), row[metric]))
+    return series
+
+def render_run_table(rows):
+    """Render the per-run results table, highlighting the highest-IPC run"""
+    best_ipc = max((r['ipc'] for r in rows), default=0)
+    out = ['<table>', '<tr><th>Run</th><th>L1D size</th><th>L1D assoc</th><th>L2</th>' +
+           ''.join(f'<th>{html.escape(label)}</th>' for _, label, _ in METRICS) + '</tr>']
+    for row in rows:
+        css = ' class="best"' if best_ipc > 0 and row['ipc'] == best_ipc else ''
+        l2 = f"{row['l2_size']} / {row['l2_assoc']}-way" if row['l2_size'] else ''
+        out.append(f'<tr{css}><td class="name">{html.escape(row["run"])}</td>'
+                   f'<td>{html.escape(str(row["l1d_size"]))}</td><td>{row["l1d_assoc"]}</td>'
+                   f'<td>{html.escape(l2)}</td>' +
+                   ''.join(f'<td>{row[key]:.4g}</td>' for key, _, _ in METRICS) + '</tr>')
+    out.append('</table>')
+    return '\n'.join(out)
+
+def summarize_application(rows):
+    """Compute the comparison summary for one application"""
+    ipcs = [r for r in rows if r['ipc'] > 0]
+    if not ipcs:
+        return None
+    best = max(ipcs, key=lambda r: r['ipc'])
+    worst = min(ipcs, key=lambda r: r['ipc'])
+    spread = (best['ipc'] - worst['ipc']) / worst['ipc']
+    return {
+        'runs': len(rows),
+        'best': best,
+        'worst': worst,
+        'spread': spread,
+        'sensitive': spread >= SENSITIVITY_THRESHOLD,
+    }
+
+def render_summary_table(by_app):
+    """Render the cross-application comparison table"""
+    out = ['<table>', '<tr><th>Application</th><th>Runs</th><th>Best config</th><th>Best IPC</th>'
+           '<th>Worst config</th><th>Worst IPC</th><th>IPC spread</th><th>Classification</th></tr>']
+    for app_name, rows in sorted(by_app.items()):
+        summary = summarize_application(rows)
+        if summary is None:
+            continue
+        best, worst = summary['best'], summary['worst']
+        label = 'cache-sensitive' if summary['sensitive'] else 'cache-insensitive'
+        out.append(f'<tr><td class="name">{html.escape(app_name)}</td><td>{summary["runs"]}</td>'
+                   f'<td class="name">{html.escape(best["run"])}</td><td>{best["ipc"]:.4f}</td>'
+                   f'<td class="name">{html.escape(worst["run"])}</td><td>{worst["ipc"]:.4f}</td>'
+                   f'<td>{summary["spread"] * 100:.1f}%</td><td class="name">{label}</td></tr>')
+    out.append('</table>')
+    return '\n'.join(out)
+
+def render_manifests(rows):
+    """Render each run's manifest as a collapsible block"""
+    out = []
+    for row in rows:
+        if row['manifest'] is None:
+            body = '<p class="meta">No manifest.json recorded for this run.</p>'
+        else:
+            body = f'<pre>{html.escape(json.dumps(row["manifest"], indent=2, sort_keys=True))}</pre>'
+        out.append(f'<details><summary>{html.escape(row["run"])}</summary>{body}</details>')
+    return '\n'.join(out)
+
+def generate_report(results_dir, rows, title):
+    """Assemble the complete HTML document"""
+    by_app = defaultdict(list)
+    for row in rows:
+        by_app[row['application']].append(row)
+
+    generated = datetime.now(timezone.utc).strftime('%Y-%m-%d %H:%M:%S UTC')
+    parts = ['<!DOCTYPE html>', '<html><head><meta charset="utf-8">',
+             f'<title>{html.escape(title)}</title>', f'<style>{STYLE}</style>', '</head><body>',
+             f'<h1>{html.escape(title)}</h1>',
+             f'<p class="meta">Source: {html.escape(os.path.abspath(results_dir))}<br>'
+             f'Generated: {generated}<br>Runs: {len(rows)}, applications: {len(by_app)}</p>',
+             '<h2>Comparison summary</h2>',
+             f'<p class="meta">Applications whose IPC varies by at least '
+             f'{SENSITIVITY_THRESHOLD * 100:.0f}% across the sweep are classified as cache-sensitive.</p>',
+             render_summary_table(by_app)]
+
+    for app_name, app_rows in sorted(by_app.items()):
+        parts.append(f'<h2>{html.escape(app_name)}</h2>')
+        parts.append('<div class="charts">')
+        for key, label, _ in METRICS[:3]:
+            parts.append(svg_line_chart(series_for(app_rows, key), f'{label} vs L1D size',
+                                        'L1D size (kB)', label))
+        parts.append('</div>')
+        parts.append(render_run_table(app_rows))
+        parts.append('<h3>Run manifests</h3>')
+        parts.append(render_manifests(app_rows))
+
+    parts.append('</body></html>')
+    return '\n'.join(parts)
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate a self-contained HTML report for a sweep')
+    parser.add_argument('results_dir', help='Directory containing simulation results')
+    parser.add_argument('-o', '--output', default='report.html',
+                       help='Output HTML file (default: report.html)')
+    parser.add_argument('--title', help='Report title (default: derived from results_dir)')
+
+    args = parser.parse_args()
+
+    results = collect_results(args.results_dir)
+
+    if not results:
+        print("No simulation results found!")
+        print("\nMake sure you have:")
+        print("1. Run gem5 simulations that create stats.txt files")
+        print("2. Organized results in subdirectories")
+        print("3. Used the correct results directory path")
+        return 1
+
+    rows = build_rows(results, args.results_dir)
+    title = args.title or f"Cache sweep report: {os.path.basename(os.path.normpath(args.results_dir))}"
+
+    with open(args.output, 'w') as f:
+        f.write(generate_report(args.results_dir, rows, title))
+
+    print(f"Report with {len(rows)} runs written to: {args.output}")
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+
+"""
+Latency-versus-bandwidth curves from the loaded-latency benchmark.
+
+Reads kernels/build/latency/loaded_latency results: CSV files written with
+--csv on the host, or gem5 run directories (run_cache_sweep.sh -n <cpus>),
+where the curve is taken from simulation.log. A binary built with
+"make -C kernels latency GEM5_ROI=1" dumps gem5's stats once per point, so
+each point is joined with the memory controller's view of it: DRAM
+bandwidth, average read and write queue lengths and the queueing delay per
+burst. Latency that grows with traffic while the queues stay short points
+at the on-chip path (L2 MSHRs, crossbar); growing queues point at DRAM.
+"""
+
+import os
+import re
+import sys
+import csv
+import argparse
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, SCRIPT_DIR)
+
+from analyze_results import parse_stats_dumps
+from analyze_phases import STAT_NAMES, get_stat
+
+try:
+    import matplotlib.pyplot as plt
+    MATPLOTLIB_AVAILABLE = True
+except ImportError:
+    MATPLOTLIB_AVAILABLE = False
+
+# Stats beyond those of analyze_phases.py, first name present wins
+EXTRA_STAT_NAMES = {
+    'queue_latency': ['system.mem_ctrl.dram.avgQLat', 'system.mem_ctrl.avgQLat'],
+    'sim_ticks': ['sim_ticks', 'simTicks'],
+}
+
+# A row of the table loaded_latency prints
+ROW = re.compile(r'^(idle|\d+)\s+([\d.]+)\s+([\d.]+)\s*$')
+
+def read_csv(path):
+    """Points of a --csv file as dicts (delay -1 is the idle point)"""
+    with open(path, newline='') as f:
+        return [{'delay': int(row['delay']),
+                 'traffic_gbps': float(row['traffic_gbps']),
+                 'latency_ns': float(row['latency_ns'])} for row in csv.DictReader(f)]
+
+def read_log(path):
+    """Points of the table in a gem5 simulation.log"""
+    points = []
+    with open(path, errors='replace') as f:
+        for line in f:
+            match = ROW.match(line.strip())
+            if match:
+                points.append({'delay': -1 if match.group(1) == 'idle' else int(match.group(1)),
+                               'traffic_gbps': float(match.group(2)),
+                               'latency_ns': float(match.group(3))})
+    return points
+
+def memory_stat(stats, name):
+    for key in EXTRA_STAT_NAMES.get(name, []):
+        value = stats.get(key)
+        if isinstance(value, float) and value == value:
+            return value
+    return get_stat(stats, name) if name in STAT_NAMES else 0.0
+
+def add_memory_stats(points, stats_path):
+    """Join each point with its stats dump; False if they do not pair up"""
+    dumps = parse_stats_dumps(stats_path) if os.path.exists(stats_path) else []
+    # gem5 dumps the stats once more when the simulation exits; that last
+    # dump follows the last point and is ignored
+    if len(dumps) not in (len(points), len(points) + 1):
+        return False
+    for point, stats in zip(points, dumps):
+        seconds = memory_stat(stats, 'sim_ticks') * 1e-12
+        dram_bytes = memory_stat(stats, 'dram_bytes_read') + memory_stat(stats, 'dram_bytes_written')
+        point['dram_gbps'] = dram_bytes / seconds / 1e9 if seconds else 0.0
+        point['read_queue'] = memory_stat(stats, 'read_queue')
+        point['write_queue'] = memory_stat(stats, 'write_queue')
+        # Ticks are picoseconds
+        point['queue_latency_ns'] = memory_stat(stats, 'queue_latency') / 1000
+    return True
+
+def load_result(path):
+    """(points, has memory stats) of a CSV file or a gem5 run directory"""
+    if os.path.isdir(path):
+        points = read_log(os.path.join(path, 'simulation.log'))
+        return points, add_memory_stats(points, os.path.join(path, 'stats.txt'))
+    return read_csv(path), False
+
+def print_curve(path, points, has_stats):
+    print(f"\n{'='*70}")
+    print(f"LOADED LATENCY: {path}")
+    print(f"{'='*70}")
+    header = f"{'Delay':<8} {'Traffic GB/s':>12} {'Latency ns':>11}"
+    if has_stats:
+        header += f" {'DRAM GB/s':>10} {'Rd queue':>9} {'Wr queue':>9} {'Queue ns':>9}"
+    print(header)
+    print("-" * len(header))
+    for point in points:
+        delay = 'idle' if point['delay'] < 0 else str(point['delay'])
+        row = f"{delay:<8} {point['traffic_gbps']:>12.2f} {point['latency_ns']:>11.1f}"
+        if has_stats:
+            row += (f" {point['dram_gbps']:>10.2f} {point['read_queue']:>9.2f}"
+                    f" {point['write_queue']:>9.2f} {point['queue_latency_ns']:>9.1f}")
+        print(row)
+
+    idle = next((p for p in points if p['delay'] < 0), None)
+    peak = max(points, key=lambda p: p['traffic_gbps'])
+    if idle and peak is not idle and idle['latency_ns'] > 0:
+        print(f"\nAt the highest traffic ({peak['traffic_gbps']:.2f} GB/s) latency is "
+              f"{peak['latency_ns']:.1f} ns, {peak['latency_ns'] / idle['latency_ns']:.2f}x idle")
+
+def plot_curves(curves, output):
+    fig, ax = plt.subplots(figsize=(8, 5))
+    for path, points in curves:
+        ax.plot([p['traffic_gbps'] for p in points], [p['latency_ns'] for p in points],
+                marker='o', label=path)
+    ax.set_xlabel('Background traffic (GB/s)')
+    ax.set_ylabel('Load-to-use latency (ns)')
+    ax.set_title('Loaded latency')
+    ax.grid(True, alpha=0.3)
+    ax.legend(fontsize='small')
+    fig.tight_layout()
+    fig.savefig(output, dpi=150)
+    print(f"\nPlot saved to {output}")
+
+def main():
+    parser = argparse.ArgumentParser(description='Latency-versus-bandwidth curves from loaded_latency')
+    parser.add_argument('results', nargs='+',
+                       help='CSV files from --csv or gem5 run directories')
+    parser.add_argument('--plot', metavar='FILE', help='Save the curves as an image (needs matplotlib)')
+
+    args = parser.parse_args()
+
+    curves = []
+    for path in args.results:
+        if not os.path.exists(path):
+            print(f"Warning: {path} not found")
+            continue
+        points, has_stats = load_result(path)
+        if not points:
+            print(f"Warning: no loaded_latency points in {path}")
+            continue
+        if os.path.isdir(path) and not has_stats:
+            print(f"Note: {path} has no per-point stats dumps "
+                  f"(build with: make -C kernels latency GEM5_ROI=1)")
+        print_curve(path, points, has_stats)
+        curves.append((path, points))
+
+    if not curves:
+        return 1
+    if args.plot:
+        if not MATPLOTLIB_AVAILABLE:
+            print("matplotlib is not available; skipping the plot")
+        else:
+            plot_curves(curves, args.plot)
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
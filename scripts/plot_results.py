@@ -13,6 +13,9 @@ import argparse
 import re
 from collections import defaultdict
 
+from analyze_results import (VARIANTS, KERNEL_FAMILIES, load_cost_model, collect_cost_points, pareto_frontier,
+                             higher_is_better)
+
 try:
     import matplotlib.pyplot as plt
     MATPLOTLIB_AVAILABLE = True
@@ -32,8 +35,13 @@ def parse_stats_file(filepath):
             for line in f:
                 line = line.strip()
                 
-                # Skip comments and empty lines
-                if line.startswith('#') or not line:
+                # Only read the first stats dump: with ROI markers
+                # (-DGEM5_ROI) it covers exactly the measured region
+                if line.startswith('---------- End Simulation Statistics'):
+                    break
+                
+                # Skip comments, dump markers and empty lines
+                if line.startswith('#') or line.startswith('-') or not line:
                     continue
                 
                 # Parse stat lines (format: stat_name value # comment)
@@ -71,11 +79,23 @@ def extract_config_from_path(result_path):
     if assoc_match:
         config['associativity'] = int(assoc_match.group(1))
     
+    # Look for L2 sweep suffix (e.g., "L2-512kB-8way")
+    l2_match = re.search(r'L2-(\d+)[kK][bB]-(\d+)way', dirname)
+    if l2_match:
+        config['l2_size'] = l2_match.group(1) + 'kB'
+        config['l2_size_kb'] = int(l2_match.group(1))
+        config['l2_assoc'] = int(l2_match.group(2))
+    
     # Extract application name from path
     path_parts = result_path.split('/')
     for part in path_parts:
-        if any(app in part for app in ['matrix_mult', 'image_blur', 'hash_ops', 'stream_bench']):
+        if any(app in part for app in KERNEL_FAMILIES):
             config['application'] = part
+            # Makefile builds are labeled <kernel>.<variant>
+            kernel, _, variant = part.partition('.')
+            if variant in VARIANTS:
+                config['kernel'] = kernel
+                config['variant'] = variant
             break
     
     return config
@@ -140,6 +160,286 @@ def get_execution_time(stats):
         return stats['sim_ticks'] * 0.5e-9
     return 0
 
+X_METRICS = ['l1d_size', 'l1d_assoc', 'l2_size', 'l2_assoc']
+Y_METRICS = ['ipc', 'l1d_miss_rate', 'l2_miss_rate', 'execution_time']
+
+X_LABEL_MAP = {
+    'l1d_size': 'L1D Cache Size (kB)',
+    'l1d_assoc': 'L1D Cache Associativity',
+    'l2_size': 'L2 Cache Size (kB)',
+    'l2_assoc': 'L2 Cache Associativity'
+}
+
+Y_LABEL_MAP = {
+    'ipc': 'Instructions Per Cycle (IPC)',
+    'l1d_miss_rate': 'L1D Cache Miss Rate',
+    'l2_miss_rate': 'L2 Cache Miss Rate',
+    'execution_time': 'Execution Time (seconds)'
+}
+
+def get_x_value(config, x_metric):
+    """Get the value of a sweep parameter for one run (0 if unknown)"""
+    if x_metric == 'l1d_size':
+        return config.get('cache_size_kb', 0)
+    elif x_metric == 'l1d_assoc':
+        return config.get('associativity', 0)
+    elif x_metric == 'l2_size':
+        return config.get('l2_size_kb', 0)
+    elif x_metric == 'l2_assoc':
+        return config.get('l2_assoc', 0)
+    return 0
+
+def get_y_value(stats, y_metric):
+    """Get the value of a result metric for one run (0 if unknown)"""
+    if y_metric == 'ipc':
+        return calculate_ipc(stats)
+    elif y_metric == 'l1d_miss_rate':
+        return calculate_miss_rate(stats, 'l1d')
+    elif y_metric == 'l2_miss_rate':
+        return calculate_miss_rate(stats, 'l2')
+    elif y_metric == 'execution_time':
+        return get_execution_time(stats)
+    return 0
+
+def group_by_application(results):
+    """Group results by application name"""
+    by_app = defaultdict(list)
+    for result in results:
+        app_name = result['config'].get('application', 'unknown')
+        by_app[app_name].append(result)
+    return by_app
+
+def build_grid(app_results, x_metric, by_metric, y_metric):
+    """Average y_metric over every (x, by) cell of a two-parameter sweep.
+    
+    Returns (x_values, by_values, grid) where grid[row][col] is indexed by
+    by_values[row] and x_values[col]; cells with no data are None.
+    """
+    cells = defaultdict(list)
+    for result in app_results:
+        x_val = get_x_value(result['config'], x_metric)
+        by_val = get_x_value(result['config'], by_metric)
+        y_val = get_y_value(result['stats'], y_metric)
+        if x_val > 0 and by_val > 0 and y_val > 0:
+            cells[(x_val, by_val)].append(y_val)
+    
+    x_values = sorted(set(x for x, _ in cells))
+    by_values = sorted(set(b for _, b in cells))
+    grid = []
+    for by_val in by_values:
+        row = []
+        for x_val in x_values:
+            values = cells.get((x_val, by_val))
+            row.append(sum(values) / len(values) if values else None)
+        grid.append(row)
+    
+    return x_values, by_values, grid
+
+def draw_grid(ax, x_values, by_values, grid, kind):
+    """Draw one heatmap or contour panel and return the mappable for a colorbar"""
+    # Masked cells stay blank rather than being drawn as zero
+    data = [[float('nan') if v is None else v for v in row] for row in grid]
+    
+    if kind == 'contour' and len(x_values) > 1 and len(by_values) > 1:
+        # Contours are drawn on log2 axes so power-of-two sweeps are evenly spaced
+        mappable = ax.contourf(x_values, by_values, data, levels=12,
+                               cmap='viridis')
+        ax.contour(x_values, by_values, data, levels=12,
+                   colors='black', linewidths=0.5, alpha=0.5)
+        ax.set_xscale('log', base=2)
+        ax.set_yscale('log', base=2)
+        ax.set_xticks(x_values)
+        ax.set_xticklabels([str(x) for x in x_values])
+        ax.set_yticks(by_values)
+        ax.set_yticklabels([str(b) for b in by_values])
+        ax.minorticks_off()
+        return mappable
+    
+    mappable = ax.imshow(data, origin='lower', aspect='auto',
+                         cmap='viridis')
+    ax.set_xticks(range(len(x_values)))
+    ax.set_xticklabels([str(x) for x in x_values])
+    ax.set_yticks(range(len(by_values)))
+    ax.set_yticklabels([str(b) for b in by_values])
+    
+    # Annotate each cell so exact values can be read off the figure
+    for row, by_val in enumerate(by_values):
+        for col, x_val in enumerate(x_values):
+            if grid[row][col] is not None:
+                ax.text(col, row, f"{grid[row][col]:.3g}",
+                        ha='center', va='center', color='white', fontsize=8)
+    return mappable
+
+def create_heatmap(results, x_metric, by_metric, y_metric, kind='heatmap', output_file=None):
+    """Create one heatmap/contour panel per application for a two-parameter sweep"""
+    
+    if not MATPLOTLIB_AVAILABLE:
+        print("Error: matplotlib not available. Install with: pip install matplotlib")
+        print("Alternatively, use: python3 scripts/analyze_results.py for tabular output")
+        return False
+    
+    by_app = group_by_application(results)
+    apps = sorted(by_app.keys())
+    
+    fig, axes = plt.subplots(1, len(apps), figsize=(6 * len(apps), 5), squeeze=False)
+    
+    drawn = False
+    for ax, app_name in zip(axes[0], apps):
+        x_values, by_values, grid = build_grid(by_app[app_name], x_metric, by_metric, y_metric)
+        if not x_values or not by_values:
+            ax.set_visible(False)
+            continue
+        
+        mappable = draw_grid(ax, x_values, by_values, grid, kind)
+        fig.colorbar(mappable, ax=ax, label=Y_LABEL_MAP.get(y_metric, y_metric))
+        ax.set_xlabel(X_LABEL_MAP.get(x_metric, x_metric))
+        ax.set_ylabel(X_LABEL_MAP.get(by_metric, by_metric))
+        ax.set_title(app_name)
+        drawn = True
+    
+    if not drawn:
+        print(f"Error: no runs vary both {x_metric} and {by_metric}")
+        plt.close(fig)
+        return False
+    
+    fig.suptitle(f'{Y_LABEL_MAP.get(y_metric, y_metric)} by '
+                 f'{X_LABEL_MAP.get(x_metric, x_metric)} and {X_LABEL_MAP.get(by_metric, by_metric)}')
+    fig.tight_layout()
+    
+    return finish_figure(fig, output_file)
+
+def create_small_multiples(results, x_metric, by_metric, facet_metrics, y_metric, output_file=None):
+    """Create a grid of line plots for sweeps with three or more parameters.
+    
+    Each panel fixes the facet parameters (first facet selects the row, the
+    optional second one the column) and draws y_metric against x_metric with
+    one line per value of by_metric. One figure is produced per application.
+    """
+    
+    if not MATPLOTLIB_AVAILABLE:
+        print("Error: matplotlib not available. Install with: pip install matplotlib")
+        print("Alternatively, use: python3 scripts/analyze_results.py for tabular output")
+        return False
+    
+    row_metric = facet_metrics[0]
+    col_metric = facet_metrics[1] if len(facet_metrics) > 1 else None
+    
+    by_app = group_by_application(results)
+    success = True
+    
+    for app_name in sorted(by_app.keys()):
+        app_results = by_app[app_name]
+        
+        row_values = sorted(set(get_x_value(r['config'], row_metric) for r in app_results) - {0})
+        col_values = sorted(set(get_x_value(r['config'], col_metric) for r in app_results) - {0}) \
+            if col_metric else [None]
+        if not row_values or not col_values:
+            print(f"Warning: {app_name} has no runs with {', '.join(facet_metrics)} set, skipping")
+            continue
+        
+        fig, axes = plt.subplots(len(row_values), len(col_values),
+                                 figsize=(4 * len(col_values), 3 * len(row_values)),
+                                 sharex=True, sharey=True, squeeze=False)
+        
+        for r, row_val in enumerate(row_values):
+            for c, col_val in enumerate(col_values):
+                ax = axes[r][c]
+                panel = [res for res in app_results
+                         if get_x_value(res['config'], row_metric) == row_val
+                         and (col_metric is None or get_x_value(res['config'], col_metric) == col_val)]
+                
+                x_values, by_values, grid = build_grid(panel, x_metric, by_metric, y_metric)
+                for i, by_val in enumerate(by_values):
+                    points = [(x, y) for x, y in zip(x_values, grid[i]) if y is not None]
+                    if points:
+                        xs, ys = zip(*points)
+                        ax.plot(xs, ys, 'o-', label=f'{by_metric}={by_val}',
+                                linewidth=1.5, markersize=4)
+                
+                title = f'{row_metric}={row_val}'
+                if col_metric:
+                    title += f', {col_metric}={col_val}'
+                ax.set_title(title, fontsize=9)
+                if x_metric in ('l1d_size', 'l2_size'):
+                    ax.set_xscale('log', base=2)
+                ax.grid(True, alpha=0.3)
+                if r == len(row_values) - 1:
+                    ax.set_xlabel(X_LABEL_MAP.get(x_metric, x_metric))
+                if c == 0:
+                    ax.set_ylabel(Y_LABEL_MAP.get(y_metric, y_metric))
+        
+        handles, labels = axes[0][0].get_legend_handles_labels()
+        if handles:
+            fig.legend(handles, labels, loc='upper right')
+        fig.suptitle(f'{app_name}: {Y_LABEL_MAP.get(y_metric, y_metric)}')
+        fig.tight_layout()
+        
+        app_output = output_file
+        if output_file and len(by_app) > 1:
+            base, ext = os.path.splitext(output_file)
+            app_output = f"{base}_{app_name}{ext}"
+        success = finish_figure(fig, app_output) and success
+    
+    return success
+
+def create_pareto_plot(results, y_metric, model, output_file=None):
+    """Scatter every configuration by cost and metric, highlighting the Pareto frontier"""
+    
+    if not MATPLOTLIB_AVAILABLE:
+        print("Error: matplotlib not available. Install with: pip install matplotlib")
+        print("Alternatively, use: python3 scripts/analyze_results.py for tabular output")
+        return False
+    
+    points = collect_cost_points(results, y_metric, model)
+    if not points:
+        print(f"Error: no runs with a {model['name']} cost")
+        return False
+    
+    maximize = higher_is_better(y_metric)
+    colors = ['blue', 'red', 'green', 'orange', 'purple']
+    
+    fig, ax = plt.subplots(figsize=(10, 6))
+    
+    for i, app_name in enumerate(sorted(points.keys())):
+        color = colors[i % len(colors)]
+        app_points = points[app_name]
+        frontier = pareto_frontier([(p[1], p[2]) for p in app_points], maximize)
+        frontier_set = set(frontier)
+        
+        dominated = [p for j, p in enumerate(app_points) if j not in frontier_set]
+        if dominated:
+            ax.scatter([p[1] for p in dominated], [p[2] for p in dominated],
+                       color=color, alpha=0.35, s=25)
+        
+        optimal = [app_points[j] for j in frontier]
+        ax.step([p[1] for p in optimal], [p[2] for p in optimal], where='post',
+                color=color, linewidth=2, label=f'{app_name} (Pareto frontier)')
+        ax.scatter([p[1] for p in optimal], [p[2] for p in optimal],
+                   color=color, edgecolors='black', s=50, zorder=3)
+        for config_name, cost, value in optimal:
+            ax.annotate(config_name, (cost, value), textcoords='offset points',
+                        xytext=(4, 4), fontsize=7)
+    
+    unit = f" ({model['unit']})" if model.get('unit') else ''
+    ax.set_xlabel(f"{model['name'].capitalize()} cost{unit}")
+    ax.set_ylabel(Y_LABEL_MAP.get(y_metric, y_metric))
+    ax.set_title(f"{Y_LABEL_MAP.get(y_metric, y_metric)} vs {model['name']} cost")
+    ax.grid(True, alpha=0.3)
+    ax.legend()
+    fig.tight_layout()
+    
+    return finish_figure(fig, output_file)
+
+def finish_figure(fig, output_file):
+    """Save a figure to output_file, or show it interactively"""
+    if output_file:
+        fig.savefig(output_file, dpi=300, bbox_inches='tight')
+        print(f"Plot saved to: {output_file}")
+        plt.close(fig)
+    else:
+        plt.show()
+    return True
+
 def create_plot(results, x_metric, y_metric, output_file=None):
     """Create a plot from the results"""
     
@@ -149,10 +449,7 @@ def create_plot(results, x_metric, y_metric, output_file=None):
         return False
     
     # Group results by application
-    by_app = defaultdict(list)
-    for result in results:
-        app_name = result['config'].get('application', 'unknown')
-        by_app[app_name].append(result)
+    by_app = group_by_application(results)
     
     plt.figure(figsize=(10, 6))
     
@@ -166,25 +463,8 @@ def create_plot(results, x_metric, y_metric, output_file=None):
             stats = result['stats']
             config = result['config']
             
-            # Get X value
-            if x_metric == 'l1d_size':
-                x_val = config.get('cache_size_kb', 0)
-            elif x_metric == 'l1d_assoc':
-                x_val = config.get('associativity', 0)
-            else:
-                continue
-            
-            # Calculate Y value
-            if y_metric == 'ipc':
-                y_val = calculate_ipc(stats)
-            elif y_metric == 'l1d_miss_rate':
-                y_val = calculate_miss_rate(stats, 'l1d')
-            elif y_metric == 'l2_miss_rate':
-                y_val = calculate_miss_rate(stats, 'l2')
-            elif y_metric == 'execution_time':
-                y_val = get_execution_time(stats)
-            else:
-                continue
+            x_val = get_x_value(config, x_metric)
+            y_val = get_y_value(stats, y_metric)
             
             if x_val > 0 and y_val > 0:
                 x_values.append(x_val)
@@ -202,23 +482,11 @@ def create_plot(results, x_metric, y_metric, output_file=None):
                     markersize=6)
     
     # Set labels and title
-    x_label_map = {
-        'l1d_size': 'L1D Cache Size (kB)',
-        'l1d_assoc': 'L1D Cache Associativity'
-    }
-    
-    y_label_map = {
-        'ipc': 'Instructions Per Cycle (IPC)',
-        'l1d_miss_rate': 'L1D Cache Miss Rate',
-        'l2_miss_rate': 'L2 Cache Miss Rate',
-        'execution_time': 'Execution Time (seconds)'
-    }
-    
-    plt.xlabel(x_label_map.get(x_metric, x_metric))
-    plt.ylabel(y_label_map.get(y_metric, y_metric))
-    plt.title(f'{y_label_map.get(y_metric, y_metric)} vs {x_label_map.get(x_metric, x_metric)}')
+    plt.xlabel(X_LABEL_MAP.get(x_metric, x_metric))
+    plt.ylabel(Y_LABEL_MAP.get(y_metric, y_metric))
+    plt.title(f'{Y_LABEL_MAP.get(y_metric, y_metric)} vs {X_LABEL_MAP.get(x_metric, x_metric)}')
     
-    if x_metric == 'l1d_size':
+    if x_metric in ('l1d_size', 'l2_size'):
         plt.xscale('log', base=2)
     
     plt.grid(True, alpha=0.3)
@@ -228,23 +496,63 @@ def create_plot(results, x_metric, y_metric, output_file=None):
     if output_file:
         plt.savefig(output_file, dpi=300, bbox_inches='tight')
         print(f"Plot saved to: {output_file}")
+        plt.close()
     else:
         plt.show()
     
     return True
 
+def plot_one(results, args, y_metric, output_file):
+    """Dispatch a single plot of y_metric according to --kind"""
+    if args.x_metric == 'cost':
+        model = load_cost_model(args.cost_model)
+        if model is None:
+            return False
+        return create_pareto_plot(results, y_metric, model, output_file)
+    elif args.kind == 'line':
+        return create_plot(results, args.x_metric, y_metric, output_file)
+    elif args.kind in ('heatmap', 'contour'):
+        return create_heatmap(results, args.x_metric, args.by, y_metric, args.kind, output_file)
+    elif args.kind == 'grid':
+        return create_small_multiples(results, args.x_metric, args.by, args.facet, y_metric, output_file)
+    return False
+
 def main():
     parser = argparse.ArgumentParser(description='Create plots from gem5 simulation results')
     parser.add_argument('results_dir', help='Directory containing simulation results')
-    parser.add_argument('x_metric', choices=['l1d_size', 'l1d_assoc'], 
-                       help='X-axis metric (independent variable)')
-    parser.add_argument('y_metric', choices=['ipc', 'l1d_miss_rate', 'l2_miss_rate', 'execution_time'],
-                       help='Y-axis metric (dependent variable)')
-    parser.add_argument('-o', '--output', help='Output file for plot (e.g., plot.png)')
+    parser.add_argument('x_metric', choices=X_METRICS + ['cost'], 
+                       help='X-axis metric (independent variable); "cost" draws a Pareto plot')
+    parser.add_argument('y_metric', choices=Y_METRICS + ['all'],
+                       help='Y-axis metric (dependent variable), or "all" to plot every metric')
+    parser.add_argument('-o', '--output', help='Output file for plot (e.g., plot.png); '
+                       'with y_metric "all", the output directory')
+    parser.add_argument('--kind', choices=['line', 'heatmap', 'contour', 'grid'], default='line',
+                       help='Plot type (default: line)')
+    parser.add_argument('--by', choices=X_METRICS,
+                       help='Second sweep parameter: heatmap/contour Y axis, or one line per value in grid plots')
+    parser.add_argument('--facet', choices=X_METRICS, nargs='+', default=[],
+                       help='Parameters splitting grid plots into rows (and columns, if two are given)')
+    parser.add_argument('--cost-model', default='area',
+                       help='Cost model for x_metric "cost": area, energy, or a JSON file (default: area)')
+    parser.add_argument('--format', default='png',
+                       help='Image format used when plotting all metrics (default: png)')
     
     args = parser.parse_args()
     
-    print(f"Creating plot: {args.y_metric} vs {args.x_metric}")
+    if args.x_metric == 'cost' and args.kind != 'line':
+        parser.error("x_metric cost draws a Pareto plot and cannot be combined with --kind")
+    if args.kind != 'line' and not args.by:
+        parser.error(f"--kind {args.kind} requires --by <parameter>")
+    if args.kind == 'grid' and not 1 <= len(args.facet) <= 2:
+        parser.error("--kind grid requires one or two --facet parameters")
+    if args.kind != 'line' and args.by == args.x_metric:
+        parser.error("--by must differ from x_metric")
+    if args.kind == 'grid':
+        dimensions = [args.x_metric, args.by] + args.facet
+        if len(set(dimensions)) != len(dimensions):
+            parser.error("x_metric, --by and each --facet parameter must all differ")
+    
+    print(f"Creating plot: {args.y_metric} vs {args.x_metric} ({'pareto' if args.x_metric == 'cost' else args.kind})")
     print(f"Data source: {args.results_dir}")
     
     # Collect results
@@ -258,12 +566,23 @@ def main():
         print("3. Used the correct results directory path")
         return 1
     
-    # Create plot
-    success = create_plot(results, args.x_metric, args.y_metric, args.output)
+    if args.y_metric == 'all':
+        # Batch mode: one file per metric, always saved rather than shown
+        out_dir = args.output or 'plots'
+        os.makedirs(out_dir, exist_ok=True)
+        success = True
+        for y_metric in Y_METRICS:
+            name = f"{y_metric}_vs_{args.x_metric}"
+            if args.kind != 'line':
+                name += f"_by_{args.by}_{args.kind}"
+            output_file = os.path.join(out_dir, f"{name}.{args.format}")
+            success = plot_one(results, args, y_metric, output_file) and success
+    else:
+        success = plot_one(results, args, args.y_metric, args.output)
     
     if success:
         print(f"\nPlot created successfully!")
-        if not args.output:
+        if not args.output and args.y_metric != 'all':
             print("Close the plot window to continue.")
     else:
         print("Failed to create plot. Use analyze_results.py for tabular output instead.")
@@ -272,4 +591,4 @@ def main():
     return 0
 
 if __name__ == "__main__":
-    sys.exit(main())
\ No newline at end of file
+    sys.exit(main())
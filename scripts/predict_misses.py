@@ -0,0 +1,468 @@
+#!/usr/bin/env python3
+
+"""
+Analytical cache-miss predictor for affine loop nests.
+
+Predicts the L1D and L2 misses of a loop nest from its loop bounds and array
+layouts, without running it, so new tile sizes or loop orders can be
+evaluated instantly and checked against a gem5 (or cachesim) sweep.
+
+The model is a footprint analysis in the style of Wolf & Lam:
+  - References to the same array with the same index coefficients form a
+    group that shares cache lines (e.g. the 25 taps of the blur stencil).
+  - F(g, k) is the number of distinct lines group g touches while loops
+    k..n-1 run once; it follows from the byte stride and trip count of each
+    loop (contiguous extents merge, larger strides multiply).
+  - Reuse carried by loop k-1 hits if the lines touched by one iteration of
+    its body, W(k) = sum of F(g, k), survive in the cache. The survival
+    probability comes from the load W(k) puts on each cache set: the set
+    loads of each group are computed from its block layout and groups are
+    assumed to be placed independently.
+  - Expected misses interpolate between "no reuse above loop k" and "reuse
+    above loop k" with those probabilities.
+
+Nests are built in for the lab kernels (matrix_mult with any loop order and
+optional tiling, image_blur) or read from JSON with --nest:
+
+  {
+    "arrays": {"A": {"dims": [256, 256], "elem": 8, "row_pitch": 2064}},
+    "loops":  [{"var": "i", "trip": 256}, {"var": "j", "trip": 256, "start": 0}],
+    "refs":   [{"array": "A", "index": [{"i": 1}, {"j": 1, "const": 0}], "write": false}]
+  }
+
+Index expressions give, per array dimension, the coefficient of each loop
+variable and a constant; loop variables run from "start" (default 0) in
+steps of 1 for "trip" iterations. row_pitch defaults to a dense layout.
+"""
+
+import os
+import sys
+import json
+import math
+import argparse
+import itertools
+from collections import Counter, defaultdict
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, SCRIPT_DIR)
+
+from analyze_results import collect_results, get_cache_params
+
+# Block layouts with more blocks than this use the average set load
+MAX_ENUMERATED_BLOCKS = 4096
+
+KERNEL_DEFAULT_SIZES = {'matrix_mult': 256, 'image_blur': 512}
+
+def parse_size(size):
+    """Convert '32kB' / '1MB' / '4096' to bytes"""
+    text = size.strip().lower().rstrip('b')
+    scale = 1
+    if text.endswith('k'):
+        scale, text = 1024, text[:-1]
+    elif text.endswith('m'):
+        scale, text = 1024 * 1024, text[:-1]
+    try:
+        return int(text) * scale
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"invalid size: {size}")
+
+def malloc_row_pitch(row_bytes):
+    """Distance between rows allocated one malloc() at a time (glibc chunks)"""
+    return max(32, (row_bytes + 8 + 15) // 16 * 16)
+
+# --- Built-in nests -----------------------------------------------------------
+
+def matrix_mult_nest(n, order='ikj', tile=None):
+    """C[i][j] += A[i][k] * B[k][j] as in matrix_mult_unopt.c (rows malloc'd)"""
+    pitch = malloc_row_pitch(n * 8)
+    arrays = {name: {'dims': [n, n], 'elem': 8, 'row_pitch': pitch} for name in 'ABC'}
+    # Row pointer arrays: every X[r][c] first loads X[r]
+    arrays.update({name + '_rows': {'dims': [n], 'elem': 8} for name in 'ABC'})
+
+    loops = []
+    if tile:
+        # Tile loops in the same order, then the point loops
+        for var in order:
+            loops.append({'var': var + var, 'trip': -(-n // tile)})
+        for var in order:
+            loops.append({'var': var, 'trip': tile})
+        index = {var: {var + var: tile, var: 1} for var in 'ijk'}
+    else:
+        for var in order:
+            loops.append({'var': var, 'trip': n})
+        index = {var: {var: 1} for var in 'ijk'}
+
+    refs = [
+        {'array': 'C_rows', 'index': [index['i']], 'write': False},
+        {'array': 'A_rows', 'index': [index['i']], 'write': False},
+        {'array': 'B_rows', 'index': [index['k']], 'write': False},
+        {'array': 'C', 'index': [index['i'], index['j']], 'write': False},
+        {'array': 'A', 'index': [index['i'], index['k']], 'write': False},
+        {'array': 'B', 'index': [index['k'], index['j']], 'write': False},
+        {'array': 'C', 'index': [index['i'], index['j']], 'write': True},
+    ]
+    return {'arrays': arrays, 'loops': loops, 'refs': refs}
+
+def image_blur_nest(n, order='xy'):
+    """5x5 stencil of image_blur_unopt.c on an n x n image (rows malloc'd)"""
+    pitch = malloc_row_pitch(n)
+    arrays = {
+        'input': {'dims': [n, n], 'elem': 1, 'row_pitch': pitch},
+        'output': {'dims': [n, n], 'elem': 1, 'row_pitch': pitch},
+        'input_rows': {'dims': [n], 'elem': 8},
+        'output_rows': {'dims': [n], 'elem': 8},
+        'kernel': {'dims': [5, 5], 'elem': 4},
+    }
+    outer = {'x': {'var': 'x', 'trip': n - 4, 'start': 2},
+             'y': {'var': 'y', 'trip': n - 4, 'start': 2}}
+    inner = {'x': {'var': 'kx', 'trip': 5, 'start': -2},
+             'y': {'var': 'ky', 'trip': 5, 'start': -2}}
+    loops = [outer[order[0]], outer[order[1]], inner[order[0]], inner[order[1]]]
+
+    refs = [
+        {'array': 'input_rows', 'index': [{'y': 1, 'ky': 1}], 'write': False},
+        {'array': 'input', 'index': [{'y': 1, 'ky': 1}, {'x': 1, 'kx': 1}], 'write': False},
+        {'array': 'kernel', 'index': [{'ky': 1, 'const': 2}, {'kx': 1, 'const': 2}], 'write': False},
+        {'array': 'output_rows', 'index': [{'y': 1}], 'write': False},
+        {'array': 'output', 'index': [{'y': 1}, {'x': 1}], 'write': True},
+    ]
+    return {'arrays': arrays, 'loops': loops, 'refs': refs}
+
+# --- Model --------------------------------------------------------------------
+
+class Group:
+    """Uniformly generated references: same array, same byte coefficients"""
+
+    def __init__(self, name, elem, coefs, offsets, accesses_per_iteration):
+        self.name = name
+        self.elem = elem
+        self.coefs = coefs                  # loop var -> byte stride
+        self.offsets = offsets              # constant byte offsets of the references
+        self.accesses_per_iteration = accesses_per_iteration
+
+def build_groups(nest):
+    """Turn the references of a nest into groups with byte strides"""
+    starts = {loop['var']: loop.get('start', 0) for loop in nest['loops']}
+    groups = {}
+    for ref in nest['refs']:
+        array = nest['arrays'][ref['array']]
+        dims = array['dims']
+        elem = array['elem']
+        if len(ref['index']) != len(dims):
+            raise ValueError(f"reference to {ref['array']} has {len(ref['index'])} indices, "
+                             f"array has {len(dims)} dimensions")
+
+        # Byte stride of each dimension; rows may be padded to row_pitch
+        strides = [elem] * len(dims)
+        for d in range(len(dims) - 2, -1, -1):
+            strides[d] = strides[d + 1] * dims[d + 1]
+            if d == len(dims) - 2 and 'row_pitch' in array:
+                strides[d] = array['row_pitch']
+
+        coefs = defaultdict(int)
+        offset = 0
+        for d, expr in enumerate(ref['index']):
+            for var, coef in expr.items():
+                if var == 'const':
+                    offset += coef * strides[d]
+                    continue
+                if var not in starts:
+                    raise ValueError(f"unknown loop variable {var} in reference to {ref['array']}")
+                coefs[var] += coef * strides[d]
+                offset += coef * starts[var] * strides[d]
+
+        key = (ref['array'], tuple(sorted((v, c) for v, c in coefs.items() if c)))
+        if key not in groups:
+            groups[key] = Group(ref['array'], elem, {v: c for v, c in coefs.items() if c}, [], 0)
+        groups[key].offsets.append(offset)
+        groups[key].accesses_per_iteration += 1
+    return list(groups.values())
+
+def footprint_terms(group, trips):
+    """(stride, count) terms of a group over the given loops, equal strides merged.
+
+    Loops and constant offsets with the same stride cover the union of
+    shifted ranges, so their counts add up minus the overlap.
+    """
+    merged = defaultdict(lambda: [0, 0])      # stride -> [sum of counts, number of terms]
+    for var, trip in trips.items():
+        stride = abs(group.coefs.get(var, 0))
+        if stride and trip > 1:
+            merged[stride][0] += trip
+            merged[stride][1] += 1
+
+    # Offsets: split the spread of distinct offsets along the existing strides
+    offsets = sorted(set(group.offsets))
+    spread = offsets[-1] - offsets[0]
+    if spread:
+        for stride in sorted(merged, reverse=True):
+            steps = spread // stride
+            if steps:
+                merged[stride][0] += steps + 1
+                merged[stride][1] += 1
+                spread -= steps * stride
+        if spread:
+            merged[spread][0] += 2
+            merged[spread][1] += 1
+
+    return sorted((stride, total - (terms - 1)) for stride, (total, terms) in merged.items())
+
+def block_layout(group, trips, line_size):
+    """Footprint of a group as (block start offsets or None, block bytes, number of blocks).
+
+    Strides up to the current contiguous extent (or within one line) extend
+    the extent; larger strides replicate it into separate blocks.
+    """
+    span = group.elem
+    block_terms = []
+    for stride, count in footprint_terms(group, trips):
+        if stride <= max(span, line_size):
+            span += stride * (count - 1)
+        else:
+            block_terms.append((stride, count))
+
+    num_blocks = 1
+    for _, count in block_terms:
+        num_blocks *= count
+    starts = None
+    if num_blocks <= MAX_ENUMERATED_BLOCKS:
+        starts = [sum(s * c for (s, _), c in zip(block_terms, combo))
+                  for combo in itertools.product(*[range(count) for _, count in block_terms])]
+    return starts, span, num_blocks
+
+def lines_per_block(span, elem, line_size):
+    """Expected lines covered by span bytes at a random element-aligned offset"""
+    return (span - elem) / line_size + 1
+
+def footprint_lines(group, trips, line_size):
+    _, span, num_blocks = block_layout(group, trips, line_size)
+    return num_blocks * lines_per_block(span, group.elem, line_size)
+
+def set_load_distribution(group, trips, line_size, num_sets):
+    """Distribution {lines in a set: fraction of sets} of a group's footprint"""
+    starts, span, num_blocks = block_layout(group, trips, line_size)
+    block_lines = max(1, round(lines_per_block(span, group.elem, line_size)))
+
+    if starts is None or num_sets == 1:
+        total = num_blocks * block_lines
+        low, extra = divmod(total, num_sets)
+        return {low: 1 - extra / num_sets, low + 1: extra / num_sets}
+
+    # Difference array over the sets: each block covers block_lines consecutive lines
+    diff = [0] * (num_sets + 1)
+    full, rest = divmod(block_lines, num_sets)
+    for start in starts:
+        first = (start // line_size) % num_sets
+        end = first + rest
+        diff[first] += 1
+        if end <= num_sets:
+            diff[end] -= 1
+        else:
+            diff[num_sets] -= 1
+            diff[0] += 1
+            diff[end - num_sets] -= 1
+    counts = Counter()
+    load = 0
+    for s in range(num_sets):
+        load += diff[s]
+        counts[load + full * len(starts)] += 1
+    return {load: count / num_sets for load, count in counts.items()}
+
+def add_loads(dist, other, cap):
+    """Distribution of the sum of two independent set loads, truncated at cap"""
+    combined = defaultdict(float)
+    for a, pa in dist.items():
+        for b, pb in other.items():
+            combined[min(a + b, cap)] += pa * pb
+    return combined
+
+def survival_probabilities(groups, trips, line_size, num_sets, assoc):
+    """Per group, the probability that one of its lines survives while the
+    given loops run once: its set must hold at most assoc footprint lines.
+
+    The set of a line of group g is a size-biased pick from g's set loads;
+    the other groups' lines land there independently.
+    """
+    loads = [set_load_distribution(g, trips, line_size, num_sets) for g in groups]
+    survival = []
+    for index, own in enumerate(loads):
+        mean = sum(load * p for load, p in own.items())
+        dist = {load: load * p / mean for load, p in own.items() if load} if mean else {1: 1.0}
+        for other_index, other in enumerate(loads):
+            if other_index != index:
+                dist = add_loads(dist, other, assoc + 1)
+        survival.append(sum(p for load, p in dist.items() if load <= assoc))
+    return survival
+
+def predict(nest, cache_size, assoc, line_size, detail=False):
+    """Expected misses (and per-group details) of a nest in one cache"""
+    groups = build_groups(nest)
+    loops = nest['loops']
+    n = len(loops)
+    num_sets = max(1, cache_size // (line_size * assoc))
+
+    def inner_trips(k):
+        return {loop['var']: loop['trip'] for loop in loops[k:]}
+
+    def outer_iterations(k):
+        return math.prod(loop['trip'] for loop in loops[:k])
+
+    # Reuse carried by loop k-1 must survive one iteration of its body (loops k..n-1)
+    survive = {k: survival_probabilities(groups, inner_trips(k), line_size, num_sets, assoc)
+               for k in range(1, n + 1)}
+
+    total = 0.0
+    rows = []
+    for index, group in enumerate(groups):
+        best = [footprint_lines(group, inner_trips(k), line_size) * outer_iterations(k)
+                for k in range(n + 1)]
+        misses = best[n]
+        for k in range(n, 0, -1):
+            misses -= survive[k][index] * (best[k] - best[k - 1])
+        total += misses
+        rows.append((group, misses, best[0], [survive[k][index] for k in range(1, n + 1)]))
+
+    if detail:
+        return total, rows
+    return total
+
+def total_accesses(nest):
+    return len(nest['refs']) * math.prod(loop['trip'] for loop in nest['loops'])
+
+# --- Reports ------------------------------------------------------------------
+
+def describe_group(group):
+    terms = ' + '.join(f"{coef}*{var}" for var, coef in sorted(group.coefs.items())) or '0'
+    return f"{group.name}[{terms}]"
+
+def print_predictions(nest, label, cache_sizes, assocs, line_size, l2_size, l2_assoc, verbose):
+    accesses = total_accesses(nest)
+    l2_misses = predict(nest, l2_size, l2_assoc, line_size)
+
+    print(f"\n{'='*70}")
+    print(f"Predicted misses: {label}")
+    print(f"{'='*70}")
+    print(f"Accesses (source level): {accesses}, L2 {l2_size // 1024}kB {l2_assoc}-way: "
+          f"{l2_misses:.0f} misses")
+    print(f"\n{'L1D':<16} {'Misses':>12} {'Miss rate':>10}")
+    print("-" * 40)
+    for size in cache_sizes:
+        for assoc in assocs:
+            misses = predict(nest, size, assoc, line_size)
+            print(f"{f'{size // 1024}kB {assoc}-way':<16} {misses:>12.0f} {misses / accesses:>10.4f}")
+
+    if verbose:
+        for size in cache_sizes:
+            for assoc in assocs:
+                _, rows = predict(nest, size, assoc, line_size, detail=True)
+                loops = ', '.join(loop['var'] for loop in nest['loops'])
+                print(f"\n{size // 1024}kB {assoc}-way (reuse survival across loops {loops}):")
+                for group, misses, cold, survival in rows:
+                    print(f"  {describe_group(group):<36} {misses:>12.0f} misses ({cold:.0f} cold)  "
+                          + ' '.join(f"{p:.2f}" for p in survival))
+
+def validate(nest, label, results_dir, line_size):
+    """Compare predictions with the stats.txt files of a sweep"""
+    results = collect_results(results_dir)
+    if not results:
+        print("No results found for validation")
+        return 1
+
+    print(f"\n{'='*78}")
+    print(f"Validation of {label} against {results_dir}")
+    print(f"{'='*78}")
+    print(f"{'Configuration':<34} {'L1D pred':>10} {'L1D meas':>10} {'Err':>7} "
+          f"{'L2 pred':>9} {'L2 meas':>9} {'Err':>7}")
+    print("-" * 92)
+
+    errors = []
+    l1d_pairs = []
+    for result in sorted(results, key=lambda r: get_cache_params(r)):
+        l1d_kb, l1d_assoc, l2_kb, l2_assoc = get_cache_params(result)
+        if not l1d_kb:
+            continue
+        stats = result['stats']
+        row = [os.path.relpath(result['path'], results_dir)]
+        for size_kb, assoc, key in ((l1d_kb, l1d_assoc, 'system.cpu.dcache.overall_misses::total'),
+                                    (l2_kb, l2_assoc, 'system.l2cache.overall_misses::total')):
+            predicted = predict(nest, size_kb * 1024, assoc, line_size)
+            measured = stats.get(key)
+            if measured and key.startswith('system.cpu.dcache'):
+                l1d_pairs.append((predicted, measured))
+            if measured:
+                error = (predicted - measured) / measured * 100
+                errors.append(abs(error))
+                row += [f"{predicted:.0f}", f"{measured:.0f}", f"{error:+.0f}%"]
+            else:
+                row += [f"{predicted:.0f}", "-", "-"]
+        print(f"{row[0]:<34} {row[1]:>10} {row[2]:>10} {row[3]:>7} {row[4]:>9} {row[5]:>9} {row[6]:>7}")
+
+    if errors:
+        print(f"\nMean absolute error: {sum(errors) / len(errors):.1f}% over {len(errors)} measurements")
+    if len(l1d_pairs) > 1:
+        # How often the prediction orders two L1D configurations like the measurement
+        pairs = [(a, b) for a, b in itertools.combinations(l1d_pairs, 2) if a[1] != b[1]]
+        agree = sum(1 for a, b in pairs if (a[0] - b[0]) * (a[1] - b[1]) > 0)
+        if pairs:
+            print(f"L1D configurations ranked in the measured order: {agree / len(pairs) * 100:.0f}% of pairs")
+        print("Measured misses include accesses outside the loop nest (stack, libc, harness).")
+    return 0
+
+def main():
+    parser = argparse.ArgumentParser(description='Analytical cache-miss prediction for affine loop nests')
+    parser.add_argument('kernel', nargs='?', choices=['matrix_mult', 'image_blur'],
+                       help='Built-in kernel nest (or use --nest)')
+    parser.add_argument('--nest', help='JSON loop nest description')
+    parser.add_argument('--size', type=int, help='Problem size (default: kernel default)')
+    parser.add_argument('--order', help='Loop order: ijk permutation for matrix_mult (default ikj), '
+                                        'xy or yx for image_blur (default xy)')
+    parser.add_argument('--tile', type=int, help='Tile size for matrix_mult')
+    parser.add_argument('--cache-size', type=parse_size, action='append', dest='cache_sizes',
+                       help='L1D size, repeatable (default: 8kB 16kB 32kB 64kB 128kB)')
+    parser.add_argument('--assoc', type=int, action='append', dest='assocs',
+                       help='L1D associativity, repeatable (default: 2)')
+    parser.add_argument('--l2-size', type=parse_size, default=parse_size('256kB'), help='L2 size (default: 256kB)')
+    parser.add_argument('--l2-assoc', type=int, default=8, help='L2 associativity (default: 8)')
+    parser.add_argument('--line-size', type=int, default=64, help='Cache line size (default: 64)')
+    parser.add_argument('--validate', metavar='RESULTS_DIR',
+                       help='Compare with the stats.txt files of a gem5 or cachesim sweep')
+    parser.add_argument('--verbose', '-v', action='store_true', help='Show per-reference predictions')
+
+    args = parser.parse_args()
+
+    if args.nest:
+        with open(args.nest, 'r') as f:
+            nest = json.load(f)
+        label = args.nest
+    elif args.kernel == 'matrix_mult':
+        size = args.size or KERNEL_DEFAULT_SIZES['matrix_mult']
+        order = args.order or 'ikj'
+        if sorted(order) != ['i', 'j', 'k']:
+            parser.error("matrix_mult --order must be a permutation of ijk")
+        nest = matrix_mult_nest(size, order, args.tile)
+        label = f"matrix_mult n={size} order={order}" + (f" tile={args.tile}" if args.tile else '')
+    elif args.kernel == 'image_blur':
+        size = args.size or KERNEL_DEFAULT_SIZES['image_blur']
+        order = args.order or 'xy'
+        if order not in ('xy', 'yx'):
+            parser.error("image_blur --order must be xy or yx")
+        nest = image_blur_nest(size, order)
+        label = f"image_blur {size}x{size} order={order}"
+    else:
+        parser.error("give a kernel or --nest")
+
+    cache_sizes = args.cache_sizes or [parse_size(s) for s in ['8kB', '16kB', '32kB', '64kB', '128kB']]
+    assocs = args.assocs or [2]
+
+    try:
+        if args.validate:
+            return validate(nest, label, args.validate, args.line_size)
+        print_predictions(nest, label, cache_sizes, assocs, args.line_size,
+                          args.l2_size, args.l2_assoc, args.verbose)
+    except (KeyError, ValueError) as e:
+        print(f"Invalid loop nest: {e}")
+        return 1
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+
+"""
+Summarize a reuse-distance profile per source line.
+
+Runs a kernel built with "make reuse" (or reads an existing profile), maps
+the instrumented instructions to source lines with addr2line, and reports
+for each line its accesses, cold misses, spatial-locality score, dominant
+stride, reuse-distance histogram and the misses it would cause in a fully
+associative LRU cache of each requested size. Lines are ranked by those
+misses, which points at the accesses (e.g. B[k][j]) behind gem5 miss rates.
+"""
+
+import os
+import re
+import sys
+import argparse
+import subprocess
+import tempfile
+from collections import defaultdict
+
+NUM_BUCKETS = 32
+DEFAULT_CACHE_SIZES = ['8kB', '32kB', '128kB']
+
+def parse_size(size):
+    """Convert '32kB' / '1MB' / '512' to bytes"""
+    match = re.fullmatch(r'(\d+)\s*([kKmM]?)[bB]?', size.strip())
+    if not match:
+        raise argparse.ArgumentTypeError(f"invalid cache size: {size}")
+    scale = {'': 1, 'k': 1024, 'm': 1024 * 1024}[match.group(2).lower()]
+    return int(match.group(1)) * scale
+
+def read_profile(path):
+    """Parse a reuse_profile.txt file into (header info, per-PC records)"""
+    info = {}
+    records = []
+    with open(path, 'r') as f:
+        for line in f:
+            if line.startswith('# reuse profile:'):
+                for key, value in re.findall(r'(\w[\w ]*?) (\d+)', line[len('# reuse profile:'):]):
+                    info[key.strip()] = int(value)
+                continue
+            if line.startswith('#') or not line.strip():
+                continue
+            parts = line.split()
+            records.append({
+                'pc': int(parts[0], 16),
+                'accesses': int(parts[1]),
+                'writes': int(parts[2]),
+                'cold': int(parts[3]),
+                'near': int(parts[4]),
+                'stride': int(parts[5]),
+                'hist': [int(x) for x in parts[6:6 + NUM_BUCKETS]],
+            })
+    return info, records
+
+def resolve_lines(binary, pcs):
+    """Map PCs to 'file:line' with addr2line (return addresses, so use pc - 1)"""
+    if not pcs:
+        return {}
+    proc = subprocess.run(['addr2line', '-e', binary] + [hex(pc - 1) for pc in pcs],
+                          stdout=subprocess.PIPE, text=True, check=True)
+    locations = proc.stdout.splitlines()
+    return {pc: re.sub(r' \(discriminator \d+\)', '', loc) for pc, loc in zip(pcs, locations)}
+
+def source_text(location, search_dirs):
+    """Return the source code at 'file:line', if the file can be found"""
+    path, _, line_no = location.rpartition(':')
+    if not line_no.isdigit():
+        return ''
+    for candidate in [path] + [os.path.join(d, os.path.basename(path)) for d in search_dirs]:
+        if os.path.exists(candidate):
+            with open(candidate, 'r') as f:
+                lines = f.readlines()
+            index = int(line_no) - 1
+            return lines[index].strip() if 0 <= index < len(lines) else ''
+    return ''
+
+def lru_misses(hist, cold, capacity_lines):
+    """Misses in a fully associative LRU cache holding capacity_lines lines.
+
+    An access misses when its reuse distance is >= the capacity. Bucket b
+    holds distances [2^(b-1), 2^b); a bucket straddling the capacity is
+    split assuming distances are uniform within it.
+    """
+    misses = cold
+    for b, count in enumerate(hist):
+        if count == 0:
+            continue
+        low = 0 if b == 0 else 1 << (b - 1)
+        high = 1 if b == 0 else 1 << b
+        if low >= capacity_lines:
+            misses += count
+        elif high > capacity_lines:
+            misses += count * (high - capacity_lines) / (high - low)
+    return misses
+
+def format_histogram(hist):
+    """Compact histogram: '<2^b:count' for non-empty buckets"""
+    parts = []
+    for b, count in enumerate(hist):
+        if count:
+            parts.append(f"{'0' if b == 0 else f'<2^{b}'}:{count}")
+    return ' '.join(parts)
+
+def main():
+    parser = argparse.ArgumentParser(description='Per-source-line reuse-distance report')
+    parser.add_argument('binary', help='Kernel built with "make reuse" (e.g. kernels/build/reuse/matrix_mult_unopt)')
+    parser.add_argument('kernel_args', nargs='*', help='Arguments for the kernel (after --)')
+    parser.add_argument('--profile', help='Use an existing profile instead of running the binary')
+    parser.add_argument('--cache-size', type=parse_size, action='append', dest='cache_sizes',
+                        help='Cache size for miss estimates, repeatable (default: 8kB 32kB 128kB)')
+    parser.add_argument('--line-size', type=int, default=64, help='Cache line size in bytes (default: 64)')
+    parser.add_argument('--top', type=int, default=15, help='Number of source lines to show (default: 15)')
+    parser.add_argument('--by-pc', action='store_true', help='Report each instruction instead of each line')
+
+    args = parser.parse_args()
+    if not args.cache_sizes:
+        args.cache_sizes = [parse_size(s) for s in DEFAULT_CACHE_SIZES]
+
+    profile_path = args.profile
+    if not profile_path:
+        profile_path = os.path.join(tempfile.mkdtemp(), 'reuse_profile.txt')
+        env = dict(os.environ, REUSE_PROFILE_FILE=profile_path, REUSE_LINE_SIZE=str(args.line_size))
+        print(f"Profiling: {' '.join([args.binary] + args.kernel_args)}")
+        subprocess.run([args.binary] + args.kernel_args, env=env, check=True,
+                       stdout=subprocess.DEVNULL)
+
+    info, records = read_profile(profile_path)
+    if not records:
+        print("Profile is empty: was the binary built with 'make reuse'?")
+        return 1
+    line_size = info.get('line_size', args.line_size)
+
+    locations = resolve_lines(args.binary, [r['pc'] for r in records])
+
+    # Aggregate per source line (or keep per instruction)
+    grouped = defaultdict(lambda: {'accesses': 0, 'writes': 0, 'cold': 0, 'near': 0,
+                                   'hist': [0] * NUM_BUCKETS, 'strides': defaultdict(int)})
+    for r in records:
+        key = f"{locations.get(r['pc'], '??')} @{r['pc']:#x}" if args.by_pc else locations.get(r['pc'], '??')
+        g = grouped[key]
+        g['accesses'] += r['accesses']
+        g['writes'] += r['writes']
+        g['cold'] += r['cold']
+        g['near'] += r['near']
+        g['hist'] = [a + b for a, b in zip(g['hist'], r['hist'])]
+        g['strides'][r['stride']] += r['accesses']
+
+    capacities = [max(1, size // line_size) for size in args.cache_sizes]
+    for g in grouped.values():
+        g['misses'] = [lru_misses(g['hist'], g['cold'], c) for c in capacities]
+
+    total_accesses = sum(g['accesses'] for g in grouped.values())
+    total_misses = [sum(g['misses'][i] for g in grouped.values()) for i in range(len(capacities))]
+    search_dirs = [os.path.dirname(os.path.abspath(args.binary)),
+                   os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'kernels')]
+
+    print(f"\n{'='*78}")
+    print(f"Reuse-distance profile: {args.binary}")
+    print(f"{'='*78}")
+    print(f"Accesses: {total_accesses}, distinct {line_size}-byte lines: {info.get('distinct lines', '?')}")
+    for size, misses in zip(args.cache_sizes, total_misses):
+        print(f"  LRU {size // 1024}kB: {misses:.0f} misses ({misses / max(total_accesses, 1) * 100:.2f}%)")
+
+    # Rank by misses at the middle cache size
+    rank_index = len(capacities) // 2
+    ranked = sorted(grouped.items(), key=lambda item: item[1]['misses'][rank_index], reverse=True)
+
+    miss_headers = ' '.join(f"{f'miss@{s // 1024}kB':>11}" for s in args.cache_sizes)
+    print(f"\n{'Source line':<32} {'Accesses':>10} {'Cold':>8} {'Spatial':>8} {'Stride':>8} {miss_headers}")
+    print("-" * (70 + 12 * len(args.cache_sizes)))
+    for key, g in ranked[:args.top]:
+        spatial = g['near'] / max(g['accesses'] - 1, 1)
+        stride = max(g['strides'], key=g['strides'].get)
+        misses = ' '.join(f"{m:>11.0f}" for m in g['misses'])
+        location = key if len(key) <= 32 else '...' + key[-29:]
+        print(f"{location:<32} {g['accesses']:>10} {g['cold']:>8} {spatial:>8.2f} {stride:>8} {misses}")
+        code = source_text(key.split(' @')[0], search_dirs)
+        if code:
+            print(f"    {code}")
+        print(f"    reuse distance (lines): {format_histogram(g['hist'])}")
+
+    print("\nSpatial = fraction of accesses within one line of the previous access by the same code;")
+    print("Stride = dominant address stride in bytes; misses assume a fully associative LRU cache.")
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
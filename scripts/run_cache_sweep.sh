@@ -10,8 +10,14 @@ BINARY=""
 OUTPUT_BASE="results"
 CACHE_SIZES="8kB 16kB 32kB 64kB 128kB"
 ASSOCIATIVITIES="2"
-L2_SIZE="256kB"
-L2_ASSOC="8"
+L2_SIZES="256kB"
+L2_ASSOCS="8"
+STATS_PERIOD=0
+WARMUP=0
+REPEAT=1
+PREFETCHERS="none"
+NUM_CPUS=1
+KERNEL_ARGS=""
 DRY_RUN=false
 
 # Colors for output
@@ -26,13 +32,20 @@ usage() {
     echo ""
     echo "Required:"
     echo "  -b <binary>           Path to the application binary to simulate"
+    echo "                        (a quoted list of binaries sweeps each in turn)"
     echo ""
     echo "Options:"
     echo "  -o <output_dir>       Base output directory (default: results)"
     echo "  -s <sizes>            Cache sizes to test (default: \"8kB 16kB 32kB 64kB 128kB\")"
     echo "  -a <associativities>  Associativities to test (default: \"2\")"
-    echo "  -l <l2_size>          L2 cache size (default: 256kB)"
-    echo "  -L <l2_assoc>         L2 cache associativity (default: 8)"
+    echo "  -l <l2_sizes>         L2 cache sizes to test (default: 256kB)"
+    echo "  -L <l2_assocs>        L2 cache associativities to test (default: 8)"
+    echo "  -p <ticks>            Dump stats every <ticks> for analyze_phases.py (default: off)"
+    echo "  -w <iterations>       Warm-up kernel iterations excluded from the stats (default: 0)"
+    echo "  -r <iterations>       Measured kernel iterations (default: 1)"
+    echo "  -P <prefetchers>      Hardware prefetchers to test: none, stride, tagged (default: none)"
+    echo "  -A <arguments>        Extra kernel arguments, e.g. \"--prefetch 256\""
+    echo "  -n <cpus>             Simulated CPUs for multithreaded binaries (default: 1)"
     echo "  -d                    Dry run - show commands without executing"
     echo "  -h                    Show this help message"
     echo ""
@@ -40,6 +53,10 @@ usage() {
     echo "  $0 -b kernels/matrix_mult_unopt"
     echo "  $0 -b kernels/image_blur_unopt -o my_results -s \"16kB 32kB 64kB\""
     echo "  $0 -b kernels/hash_ops -a \"2 4 8\" -d"
+    echo "  $0 -b kernels/matrix_mult_unopt -a \"2 4\" -l \"256kB 1024kB\""
+    echo "  $0 -b kernels/build/static/matrix_mult_unopt -w 1 -r 2"
+    echo "  $0 -b \"\$(ls kernels/build/static/matrix_mult_*)\" -s \"8kB 32kB\""
+    echo "  $0 -b kernels/build/static/stream_bench -s 32kB -P \"none stride\" -A --prefetch-sweep"
 }
 
 log_info() {
@@ -58,8 +75,63 @@ log_error() {
     echo -e "${RED}[ERROR]${NC} $1"
 }
 
+# A string as a JSON literal, quotes and backslashes escaped
+json_string() {
+    python3 -c 'import json, sys; print(json.dumps(sys.argv[1]))' "$1"
+}
+
+# Record how a run was produced so results can be traced and archived.
+# Arguments: run_dir l1d_size l1d_assoc l2_size l2_assoc prefetcher status start_time
+write_manifest() {
+    local run_dir="$1"
+    local binary_hash
+    local iterations
+    local warmup_done
+    local measured
+    local per_dump
+    # Hashed from stdin: sha256sum escapes names containing a backslash
+    binary_hash=$(sha256sum < "$BINARY" 2>/dev/null | cut -d' ' -f1)
+
+    # Iterations the kernel reports having run ("<w> warmup + <r> timed runs");
+    # null when the log does not say, e.g. after a failed run
+    iterations=$(grep -o '[0-9]* warmup + [0-9]* timed runs' "$run_dir/simulation.log" 2>/dev/null | tail -1)
+    warmup_done=$(echo "$iterations" | awk '{print $1}')
+    measured=$(echo "$iterations" | awk '{print $4}')
+    # Timed runs each ROI stats dump covers: all of them, or one for kernels
+    # that reset their data between runs (GEM5_ROI builds only)
+    per_dump=$(grep -o 'gem5 ROI: [0-9]* timed runs per stats dump' "$run_dir/simulation.log" 2>/dev/null \
+        | tail -1 | awk '{print $3}')
+    cat > "$run_dir/manifest.json" <<EOF
+{
+  "application": $(json_string "$APP_NAME"),
+  "binary": $(json_string "$BINARY"),
+  "binary_sha256": "$binary_hash",
+  "l1d_size": "$2",
+  "l1d_assoc": $3,
+  "l2_size": "$4",
+  "l2_assoc": $5,
+  "prefetcher": "$6",
+  "kernel_args": $(json_string "$KERNEL_ARGS"),
+  "num_cpus": $NUM_CPUS,
+  "stats_period": $STATS_PERIOD,
+  "warmup": ${warmup_done:-null},
+  "measured_iterations": ${measured:-null},
+  "iterations_per_dump": ${per_dump:-null},
+  "roi_markers": $ROI_MARKERS,
+  "status": "$7",
+  "started": "$8",
+  "finished": "$(date -u +%Y-%m-%dT%H:%M:%SZ)",
+  "host": $(json_string "$(hostname)"),
+  "gem5": $(json_string "$(command -v gem5.opt)")
+}
+EOF
+}
+
+# Kept to sweep several binaries with the same options
+ARGS=("$@")
+
 # Parse command line arguments
-while getopts "b:o:s:a:l:L:dh" opt; do
+while getopts "b:o:s:a:l:L:p:w:r:P:A:n:dh" opt; do
     case $opt in
         b)
             BINARY="$OPTARG"
@@ -74,10 +146,28 @@ while getopts "b:o:s:a:l:L:dh" opt; do
             ASSOCIATIVITIES="$OPTARG"
             ;;
         l)
-            L2_SIZE="$OPTARG"
+            L2_SIZES="$OPTARG"
             ;;
         L)
-            L2_ASSOC="$OPTARG"
+            L2_ASSOCS="$OPTARG"
+            ;;
+        p)
+            STATS_PERIOD="$OPTARG"
+            ;;
+        w)
+            WARMUP="$OPTARG"
+            ;;
+        r)
+            REPEAT="$OPTARG"
+            ;;
+        P)
+            PREFETCHERS="$OPTARG"
+            ;;
+        A)
+            KERNEL_ARGS="$OPTARG"
+            ;;
+        n)
+            NUM_CPUS="$OPTARG"
             ;;
         d)
             DRY_RUN=true
@@ -101,11 +191,20 @@ if [ -z "$BINARY" ]; then
     exit 1
 fi
 
+# Several binaries: sweep each in turn with the same options (the last -b wins)
+if [ $(echo $BINARY | wc -w) -gt 1 ]; then
+    STATUS=0
+    for binary in $BINARY; do
+        "$0" "${ARGS[@]}" -b "$binary" || STATUS=1
+    done
+    exit $STATUS
+fi
+
 # Check if binary exists
 if [ ! -f "$BINARY" ]; then
     log_error "Binary not found: $BINARY"
     log_info "Make sure to compile your kernels first:"
-    log_info "  cd kernels && gcc -O2 -o matrix_mult_unopt matrix_mult_unopt.c"
+    log_info "  cd kernels && gcc -O2 -o matrix_mult_unopt matrix_mult_unopt.c harness.c perf_counters.c -lm"
     exit 1
 fi
 
@@ -118,12 +217,54 @@ fi
 
 # Extract application name from binary path
 APP_NAME=$(basename "$BINARY")
+
+# Binaries built by kernels/Makefile live in build/<variant>/<kernel>; label
+# their results <kernel>.<variant> so variants of a kernel stay apart
+if [ "$(basename "$(dirname "$(dirname "$BINARY")")")" = "build" ]; then
+    APP_NAME="${APP_NAME}.$(basename "$(dirname "$BINARY")")"
+fi
 APP_OUTPUT_DIR="$OUTPUT_BASE/$APP_NAME"
 
 log_info "Starting cache size sweep for $APP_NAME"
 log_info "Output directory: $APP_OUTPUT_DIR"
 log_info "Cache sizes: $CACHE_SIZES"
 log_info "Associativities: $ASSOCIATIVITIES"
+log_info "L2 sizes: $L2_SIZES, L2 associativities: $L2_ASSOCS"
+log_info "Kernel iterations: $WARMUP warm-up, $REPEAT measured"
+log_info "Hardware prefetchers: $PREFETCHERS"
+if [ "$NUM_CPUS" != "1" ]; then
+    log_info "CPUs: $NUM_CPUS"
+fi
+if [ -n "$KERNEL_ARGS" ]; then
+    log_info "Kernel arguments: $KERNEL_ARGS"
+fi
+
+# Only binaries built with ROI markers reset the stats after warm-up
+ROI_MARKERS=false
+if grep -qa m5_reset_stats "$BINARY"; then
+    ROI_MARKERS=true
+elif [ "$WARMUP" != "0" ]; then
+    log_warning "$BINARY has no gem5 ROI markers: stats will include the warm-up iterations"
+    log_warning "Build it with: make -C kernels static GEM5_ROI=1"
+fi
+
+if [ "$STATS_PERIOD" != "0" ]; then
+    log_warning "Stats dumped every $STATS_PERIOD ticks: analyze these runs with analyze_phases.py"
+    log_warning "(analyze_results.py only reads the first dump, i.e. the first interval)"
+fi
+
+# Only tag run directories with the L2 config when it is actually swept,
+# so single-L2 sweeps keep the plain <size>_assoc<n> layout
+L2_SWEPT=false
+if [ $(echo $L2_SIZES | wc -w) -gt 1 ] || [ $(echo $L2_ASSOCS | wc -w) -gt 1 ]; then
+    L2_SWEPT=true
+fi
+
+# Likewise, tag them with the prefetcher only when one is configured
+PF_TAGGED=false
+if [ "$PREFETCHERS" != "none" ]; then
+    PF_TAGGED=true
+fi
 
 # Create output directory
 if [ "$DRY_RUN" = false ]; then
@@ -135,49 +276,76 @@ TOTAL_RUNS=0
 CURRENT_RUN=0
 
 # Count total number of runs
+for prefetcher in $PREFETCHERS; do
+for l2_size in $L2_SIZES; do
+for l2_assoc in $L2_ASSOCS; do
 for size in $CACHE_SIZES; do
     for assoc in $ASSOCIATIVITIES; do
-        ((TOTAL_RUNS++))
+        TOTAL_RUNS=$((TOTAL_RUNS + 1))
     done
 done
+done
+done
+done
 
 log_info "Total simulations to run: $TOTAL_RUNS"
 
 # Run the experiments
+for prefetcher in $PREFETCHERS; do
+for l2_size in $L2_SIZES; do
+for l2_assoc in $L2_ASSOCS; do
 for size in $CACHE_SIZES; do
     for assoc in $ASSOCIATIVITIES; do
-        ((CURRENT_RUN++))
+        CURRENT_RUN=$((CURRENT_RUN + 1))
         
         # Create descriptive directory name
         RUN_DIR="${APP_OUTPUT_DIR}/${size}_assoc${assoc}"
+        if [ "$L2_SWEPT" = true ]; then
+            RUN_DIR="${RUN_DIR}_L2-${l2_size}-${l2_assoc}way"
+        fi
+        if [ "$PF_TAGGED" = true ]; then
+            RUN_DIR="${RUN_DIR}_pf-${prefetcher}"
+        fi
         
-        # Prepare the command
-        CMD="gem5.opt scripts/cache_experiment.py \
-            --l1d_size $size \
-            --l1d_assoc $assoc \
-            --l2_size $L2_SIZE \
-            --l2_assoc $L2_ASSOC \
-            --binary $BINARY \
-            --out_dir $RUN_DIR"
+        # Prepare the command (an array, so kernel arguments stay one word)
+        CMD=(gem5.opt -d "$RUN_DIR" scripts/cache_experiment.py
+            --l1d_size "$size"
+            --l1d_assoc "$assoc"
+            --l2_size "$l2_size"
+            --l2_assoc "$l2_assoc"
+            --prefetcher "$prefetcher"
+            --num_cpus "$NUM_CPUS"
+            --binary "$BINARY"
+            --stats_period "$STATS_PERIOD"
+            --warmup "$WARMUP"
+            --repeat "$REPEAT"
+            --kernel_args="$KERNEL_ARGS"
+            --out_dir "$RUN_DIR")
         
-        log_info "[$CURRENT_RUN/$TOTAL_RUNS] Running: L1D=${size}, Assoc=${assoc}"
+        log_info "[$CURRENT_RUN/$TOTAL_RUNS] Running: L1D=${size}, Assoc=${assoc}, L2=${l2_size}/${l2_assoc}-way, prefetcher=${prefetcher}"
         
         if [ "$DRY_RUN" = true ]; then
-            echo "Would run: $CMD"
+            echo "Would run: ${CMD[*]}"
         else
             # Create run directory
             mkdir -p "$RUN_DIR"
             
             # Run the simulation
-            if $CMD > "$RUN_DIR/simulation.log" 2>&1; then
+            START_TIME=$(date -u +%Y-%m-%dT%H:%M:%SZ)
+            if "${CMD[@]}" > "$RUN_DIR/simulation.log" 2>&1; then
+                write_manifest "$RUN_DIR" "$size" "$assoc" "$l2_size" "$l2_assoc" "$prefetcher" "completed" "$START_TIME"
                 log_success "Completed: L1D=${size}, Assoc=${assoc}"
             else
+                write_manifest "$RUN_DIR" "$size" "$assoc" "$l2_size" "$l2_assoc" "$prefetcher" "failed" "$START_TIME"
                 log_error "Failed: L1D=${size}, Assoc=${assoc}"
                 log_info "Check log file: $RUN_DIR/simulation.log"
             fi
         fi
     done
 done
+done
+done
+done
 
 if [ "$DRY_RUN" = false ]; then
     log_success "All simulations completed!"
@@ -186,6 +354,7 @@ if [ "$DRY_RUN" = false ]; then
     log_info "To analyze results, run:"
     log_info "  python3 scripts/analyze_results.py $APP_OUTPUT_DIR l1d_size ipc"
     log_info "  python3 scripts/analyze_results.py $APP_OUTPUT_DIR l1d_size l1d_miss_rate"
+    log_info "  python3 scripts/generate_report.py $APP_OUTPUT_DIR -o $APP_OUTPUT_DIR/report.html"
 else
     log_info "Dry run completed. Use -d flag to see commands without executing."
 fi
\ No newline at end of file
@@ -0,0 +1,114 @@
+#!/bin/bash
+
+# Native Run Script
+# This script runs a kernel natively with hardware counters enabled and
+# stores the counts as gem5-style stats.txt files for the analysis scripts
+
+set -e  # Exit on any error
+
+# Default values
+BINARY=""
+OUTPUT_BASE="results/native"
+REPEATS=3
+
+# Colors for output
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+BLUE='\033[0;34m'
+NC='\033[0m' # No Color
+
+usage() {
+    echo "Usage: $0 -b <binary> [options]"
+    echo ""
+    echo "Required:"
+    echo "  -b <binary>           Path to the application binary (linked with perf_counters.c)"
+    echo ""
+    echo "Options:"
+    echo "  -o <output_dir>       Base output directory (default: results/native)"
+    echo "  -r <repeats>          Number of runs (default: 3)"
+    echo "  -h                    Show this help message"
+    echo ""
+    echo "Examples:"
+    echo "  $0 -b kernels/matrix_mult_unopt"
+    echo "  $0 -b kernels/stream_bench -r 10"
+}
+
+log_info() {
+    echo -e "${BLUE}[INFO]${NC} $1"
+}
+
+log_success() {
+    echo -e "${GREEN}[SUCCESS]${NC} $1"
+}
+
+log_error() {
+    echo -e "${RED}[ERROR]${NC} $1"
+}
+
+# Parse command line arguments
+while getopts "b:o:r:h" opt; do
+    case $opt in
+        b)
+            BINARY="$OPTARG"
+            ;;
+        o)
+            OUTPUT_BASE="$OPTARG"
+            ;;
+        r)
+            REPEATS="$OPTARG"
+            ;;
+        h)
+            usage
+            exit 0
+            ;;
+        \?)
+            log_error "Invalid option: -$OPTARG"
+            usage
+            exit 1
+            ;;
+    esac
+done
+
+if [ -z "$BINARY" ]; then
+    log_error "Binary path is required"
+    usage
+    exit 1
+fi
+
+if [ ! -f "$BINARY" ]; then
+    log_error "Binary not found: $BINARY"
+    exit 1
+fi
+
+APP_NAME=$(basename "$BINARY")
+
+# Binaries built by kernels/Makefile live in build/<variant>/<kernel>; label
+# their results <kernel>.<variant> so variants of a kernel stay apart
+if [ "$(basename "$(dirname "$(dirname "$BINARY")")")" = "build" ]; then
+    APP_NAME="${APP_NAME}.$(basename "$(dirname "$BINARY")")"
+fi
+
+HOST=$(hostname -s)
+APP_OUTPUT_DIR="$OUTPUT_BASE/$APP_NAME"
+
+log_info "Running $APP_NAME natively on $HOST ($REPEATS runs)"
+log_info "Output directory: $APP_OUTPUT_DIR"
+
+for run in $(seq 1 "$REPEATS"); do
+    RUN_DIR="${APP_OUTPUT_DIR}/${HOST}_run${run}"
+    mkdir -p "$RUN_DIR"
+
+    if PERF_STATS_FILE="$RUN_DIR/stats.txt" "$BINARY" > "$RUN_DIR/output.log" 2>&1; then
+        log_success "[$run/$REPEATS] $(grep -m1 'checksum' "$RUN_DIR/output.log" || true)"
+    else
+        log_error "[$run/$REPEATS] Run failed, check $RUN_DIR/output.log"
+        exit 1
+    fi
+
+    if grep -q "unavailable" "$RUN_DIR/output.log"; then
+        log_info "Some counters were unavailable (see $RUN_DIR/output.log);"
+        log_info "check /proc/sys/kernel/perf_event_paranoid"
+    fi
+done
+
+log_success "Native runs saved in: $APP_OUTPUT_DIR"
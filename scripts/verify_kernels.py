@@ -0,0 +1,281 @@
+#!/usr/bin/env python3
+
+"""
+Verify kernel variants against reference implementations.
+
+Each candidate binary and its reference are run at several problem sizes
+with --dump (see kernels/harness.h). Integer outputs must be bit-identical
+(compared by SHA-256 hash); floating-point outputs may differ by at most
+--max-ulps units in the last place per element, which allows reassociation
+and FMA contraction but catches indexing and tiling bugs. Factorization
+outputs contain entries that cancel to roundoff, where ulps are meaningless;
+those families are compared normwise instead (see NORMWISE_TOLERANCE).
+"""
+
+import os
+import sys
+import re
+import argparse
+import hashlib
+import subprocess
+import tempfile
+from array import array
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+KERNELS_DIR = os.path.join(os.path.dirname(SCRIPT_DIR), 'kernels')
+BUILD_DIR = os.path.join(KERNELS_DIR, 'build')
+REFERENCE_VARIANT = 'o2'
+
+# Sizes per kernel family; odd sizes catch tiling and unrolling edge cases
+DEFAULT_SIZES = {
+    'matrix_mult': [64, 100, 256],
+    'image_blur': [64, 257, 512],
+    'stream_bench': [1000, 65536, 1048576],
+    'batched_gemm': [1, 13, 512],
+    'lu_factor': [64, 100, 256],
+    'cholesky': [64, 100, 256],
+    'conv2d': [8, 17, 32],
+}
+
+# Families whose f64 outputs may instead differ by this fraction of the
+# section's largest magnitude: LU and Cholesky factors have near-zero
+# entries whose ulp distance explodes under FMA contraction
+NORMWISE_TOLERANCE = {
+    'lu_factor': 1e-10,
+    'cholesky': 1e-10,
+}
+
+# Element-type variants (matrix_mult_i8_t32) multiply integer-valued
+# inputs instead of the family's; each is checked against the untiled
+# kernel of its type (matrix_mult_i8)
+ELEMENT_TYPES = ('f32', 'i16', 'i8')
+
+# Kernels whose output covers more than their family's _unopt kernel
+# writes (image_blur_box also fills the border): checked against their own
+# o2 build, which checks itself against a reference implementation
+SELF_REFERENCED = ('image_blur_box',)
+
+# Extra runs of a kernel against another family member: options that
+# restrict its output to what the other kernel writes (image_blur_box
+# --border none dumps only the interior, checked against image_blur_unopt)
+CROSS_CHECKS = {
+    'image_blur_box': (['--border', 'none'], 'image_blur_unopt'),
+}
+
+# Trailing parameters that change the problem, not the algorithm: the
+# channel count of conv2d_im2col_c16 (checked against conv2d_unopt_c16)
+PROBLEM_SUFFIX = re.compile(r'_c\d+$')
+
+TYPE_CODES = {'u8': 'B', 'f64': 'd'}
+
+def kernel_name(binary):
+    """Kernel name of a binary, e.g. matrix_mult_opt"""
+    return os.path.basename(binary)
+
+def default_reference(binary):
+    """Reference binary for a candidate: the o2 build of its family's _unopt
+    kernel (image_blur_opt is checked against image_blur_unopt), or for
+    element-type variants the untiled kernel of the type; a PROBLEM_SUFFIX
+    is kept. SELF_REFERENCED kernels are checked against their o2 build."""
+    name = kernel_name(binary)
+    if name in SELF_REFERENCED:
+        return os.path.join(BUILD_DIR, REFERENCE_VARIANT, name)
+    suffix = PROBLEM_SUFFIX.search(name)
+    suffix = suffix.group() if suffix else ''
+    for family in DEFAULT_SIZES:
+        if name.startswith(family + '_'):
+            element_type = name[len(family) + 1:].split('_')[0]
+            name = family + '_' + (element_type if element_type in ELEMENT_TYPES else 'unopt') + suffix
+            break
+    return os.path.join(BUILD_DIR, REFERENCE_VARIANT, name)
+
+def default_sizes(binary):
+    name = kernel_name(binary)
+    for family, sizes in DEFAULT_SIZES.items():
+        if name.startswith(family):
+            return sizes
+    return None
+
+def normwise_tolerance(binary):
+    name = kernel_name(binary)
+    return next((tol for family, tol in NORMWISE_TOLERANCE.items() if name.startswith(family)), None)
+
+def read_dump(path):
+    """Read a --dump file into a list of (type, raw bytes) sections"""
+    sections = []
+    with open(path, 'rb') as f:
+        while True:
+            header = f.readline()
+            if not header:
+                break
+            type_name, count = header.decode().split()
+            data = f.read(int(count) * array(TYPE_CODES[type_name]).itemsize)
+            sections.append((type_name, data))
+    return sections
+
+def run_dump(binary, size, dump_path, options=()):
+    """Run a binary with --dump and any kernel options; return an error
+    message or None"""
+    try:
+        proc = subprocess.run([binary, *options, '--size', str(size), '--dump', dump_path],
+                              stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    except OSError as e:
+        return str(e)
+    # Exit code 1 means a checksum mismatch, which the comparison reports in detail
+    if proc.returncode not in (0, 1):
+        return f"exited with code {proc.returncode}: {proc.stdout.strip()[-200:]}"
+    return None
+
+def ordered_bits(values):
+    """Map doubles to integers whose difference is the distance in ULPs"""
+    bits = array('q')
+    bits.frombytes(values.tobytes())
+    return [b if b >= 0 else -(b & 0x7FFFFFFFFFFFFFFF) for b in bits]
+
+def compare_section(type_name, expected, actual, max_ulps, normwise=None):
+    """Compare one section; return (ok, detail)"""
+    if len(expected) != len(actual):
+        return False, f"size differs ({len(actual)} vs {len(expected)} bytes)"
+
+    if type_name != 'f64':
+        if hashlib.sha256(expected).digest() == hashlib.sha256(actual).digest():
+            return True, f"{type_name}[{len(expected)}] hash {hashlib.sha256(actual).hexdigest()[:16]}"
+        for i, (e, a) in enumerate(zip(expected, actual)):
+            if e != a:
+                return False, f"first mismatch at element {i}: {a} (expected {e})"
+
+    exp_values = array('d', expected)
+    act_values = array('d', actual)
+    exp_bits = ordered_bits(exp_values)
+    act_bits = ordered_bits(act_values)
+
+    worst = 0
+    worst_index = 0
+    for i in range(len(exp_values)):
+        if exp_values[i] != exp_values[i] or act_values[i] != act_values[i]:
+            # NaN only matches NaN
+            if not (exp_values[i] != exp_values[i] and act_values[i] != act_values[i]):
+                return False, f"NaN mismatch at element {i}"
+            continue
+        diff = abs(exp_bits[i] - act_bits[i])
+        if diff > worst:
+            worst, worst_index = diff, i
+
+    detail = f"f64[{len(exp_values)}] max {worst} ulps"
+    if worst > max_ulps and normwise is not None:
+        scale = max((abs(v) for v in exp_values), default=0.0) or 1.0
+        worst_abs = max(abs(e - a) for e, a in zip(exp_values, act_values))
+        detail += f", max difference {worst_abs / scale:.1e} of the largest element"
+        if worst_abs <= normwise * scale:
+            return True, detail
+        return False, f"{detail} (allowed {normwise:.0e})"
+    if worst > max_ulps:
+        return False, (f"{detail} at element {worst_index}: {act_values[worst_index]!r} "
+                       f"(expected {exp_values[worst_index]!r})")
+    return True, detail
+
+def verify(candidate, reference, sizes, max_ulps, tmp_dir, options=()):
+    """Verify one candidate at every size; return the number of failures"""
+    failures = 0
+    normwise = normwise_tolerance(candidate)
+    for size in sizes:
+        label = ' '.join([candidate, *options, 'size', str(size)])
+        ref_dump = os.path.join(tmp_dir, f"{kernel_name(reference)}_{size}.ref")
+        cand_dump = os.path.join(tmp_dir, 'candidate.dump')
+
+        # Reference dumps are reused across candidates
+        if not os.path.exists(ref_dump):
+            error = run_dump(reference, size, ref_dump)
+            if error:
+                print(f"ERROR {label}: reference {reference} {error}")
+                failures += 1
+                continue
+
+        error = run_dump(candidate, size, cand_dump, options)
+        if error:
+            print(f"FAIL  {label}: {error}")
+            failures += 1
+            continue
+
+        expected = read_dump(ref_dump)
+        actual = read_dump(cand_dump)
+        if len(expected) != len(actual) or any(e[0] != a[0] for e, a in zip(expected, actual)):
+            print(f"FAIL  {label}: output layout differs from {reference}")
+            failures += 1
+            continue
+
+        details = []
+        ok = True
+        for (type_name, exp_data), (_, act_data) in zip(expected, actual):
+            section_ok, detail = compare_section(type_name, exp_data, act_data, max_ulps, normwise)
+            ok = ok and section_ok
+            details.append(detail)
+
+        print(f"{'PASS' if ok else 'FAIL'}  {label}: {'; '.join(details)}")
+        if not ok:
+            failures += 1
+    return failures
+
+def all_built_variants():
+    """Every binary under kernels/build/<variant>/ except the references
+    (a reference with CROSS_CHECKS is kept for those)"""
+    binaries = []
+    if not os.path.isdir(BUILD_DIR):
+        return binaries
+    for variant in sorted(os.listdir(BUILD_DIR)):
+        variant_dir = os.path.join(BUILD_DIR, variant)
+        if variant in ('profiles', 'reuse', 'video', 'latency') or not os.path.isdir(variant_dir):
+            continue
+        for name in sorted(os.listdir(variant_dir)):
+            path = os.path.join(variant_dir, name)
+            if os.access(path, os.X_OK) and (default_reference(path) != path or name in CROSS_CHECKS):
+                binaries.append(path)
+    return binaries
+
+def main():
+    parser = argparse.ArgumentParser(description='Verify kernel outputs against reference implementations')
+    parser.add_argument('binaries', nargs='*', help='Candidate kernel binaries')
+    parser.add_argument('--all', action='store_true',
+                       help='Verify every variant in kernels/build against the o2 build')
+    parser.add_argument('--reference', help='Reference binary (default: o2 build of the _unopt kernel)')
+    parser.add_argument('--sizes', type=int, nargs='+', help='Problem sizes (default: per kernel)')
+    parser.add_argument('--max-ulps', type=int, default=64,
+                       help='Allowed floating-point difference in ULPs (default: 64)')
+
+    args = parser.parse_args()
+
+    candidates = list(args.binaries)
+    if args.all:
+        candidates += all_built_variants()
+    if not candidates:
+        parser.error("no binaries to verify (give paths or --all)")
+
+    failures = 0
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        for candidate in candidates:
+            reference = args.reference or default_reference(candidate)
+            sizes = args.sizes or default_sizes(candidate)
+            if not os.path.exists(reference):
+                print(f"ERROR {candidate}: reference {reference} not found (build it or use --reference)")
+                failures += 1
+                continue
+            if not sizes:
+                print(f"ERROR {candidate}: no default sizes for this kernel, use --sizes")
+                failures += 1
+                continue
+            if os.path.abspath(reference) != os.path.abspath(candidate):
+                failures += verify(candidate, reference, sizes, args.max_ulps, tmp_dir)
+            if not args.reference and kernel_name(candidate) in CROSS_CHECKS:
+                options, other = CROSS_CHECKS[kernel_name(candidate)]
+                other = os.path.join(BUILD_DIR, REFERENCE_VARIANT, other)
+                if not os.path.exists(other):
+                    print(f"ERROR {candidate}: reference {other} not found")
+                    failures += 1
+                    continue
+                failures += verify(candidate, other, sizes, args.max_ulps, tmp_dir, options)
+
+    print(f"\n{'All outputs match' if failures == 0 else f'{failures} verification failure(s)'}")
+    return 1 if failures else 0
+
+if __name__ == "__main__":
+    sys.exit(main())